@@ -0,0 +1,66 @@
+#include "AllocationCounter.h"
+
+# include <atomic>
+# include <cstdlib>
+# include <new>
+
+namespace
+{
+	std::atomic<size_t> allocations(0);
+	std::atomic<size_t> allocatedBytes(0);
+
+	void* CountedAllocate(size_t size)
+	{
+		allocations.fetch_add(1, std::memory_order_relaxed);
+		allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+		void* memory = std::malloc(size == 0 ? 1 : size);
+		if (!memory) throw std::bad_alloc();
+		return memory;
+	}
+}
+
+void* operator new(size_t size)
+{
+	return CountedAllocate(size);
+}
+
+void* operator new[](size_t size)
+{
+	return CountedAllocate(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
+
+AllocationCount GetAllocationCount()
+{
+	AllocationCount count;
+	count.allocations = allocations.load(std::memory_order_relaxed);
+	count.bytes = allocatedBytes.load(std::memory_order_relaxed);
+	return count;
+}
+
+AllocationCount operator-(const AllocationCount& a, const AllocationCount& b)
+{
+	AllocationCount count;
+	count.allocations = a.allocations - b.allocations;
+	count.bytes = a.bytes - b.bytes;
+	return count;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+# include <cstddef>
+
+// Подсчёт выделений памяти в куче
+// Глобальные operator new/delete бенчмарков заменены на считающие
+
+struct AllocationCount
+{
+	size_t allocations = 0; // Число вызовов operator new
+	size_t bytes = 0;       // Суммарно запрошено байт
+};
+
+// Текущие значения счётчиков с момента запуска
+AllocationCount GetAllocationCount();
+
+// Разность счётчиков между двумя моментами
+AllocationCount operator-(const AllocationCount&, const AllocationCount&);
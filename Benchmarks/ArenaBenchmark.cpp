@@ -0,0 +1,50 @@
+#include "ArenaBenchmark.h"
+
+# include "AllocationCounter.h"
+# include "ProgramGenerator.h"
+# include "Arena.h"
+# include "Lexer.h"
+# include "Parser.h"
+# include <chrono>
+# include <iostream>
+# include <sstream>
+# include <string>
+
+namespace
+{
+	double Milliseconds(std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end)
+	{
+		return std::chrono::duration<double, std::milli>(end - begin).count();
+	}
+}
+
+void RunArenaBenchmark()
+{
+	const size_t size = 10 * 1024 * 1024;
+	SymbolTable symbols;
+
+	std::istringstream in(GenerateProgram(size));
+	std::cout << "Arena benchmark (" << in.str().size() << " bytes of source)" << std::endl;
+
+	auto arena = new Arena();
+
+	auto beforeParse = GetAllocationCount();
+	auto parseBegin = std::chrono::steady_clock::now();
+	Lexer lexer(symbols, in);
+	Parser parser(lexer, *arena);
+	parser.Parse();
+	auto parseEnd = std::chrono::steady_clock::now();
+	auto parseAllocations = GetAllocationCount() - beforeParse;
+
+	auto& stats = arena->GetStats();
+	std::cout << "lex+parse: " << Milliseconds(parseBegin, parseEnd) << " ms, "
+		<< parseAllocations.allocations << " heap allocations" << std::endl;
+	std::cout << "arena: " << stats.objects << " objects in "
+		<< stats.blocks << " blocks (" << stats.blockBytes << " bytes), "
+		<< stats.destructors << " destructors" << std::endl;
+
+	auto releaseBegin = std::chrono::steady_clock::now();
+	delete arena;
+	auto releaseEnd = std::chrono::steady_clock::now();
+	std::cout << "release: " << Milliseconds(releaseBegin, releaseEnd) << " ms" << std::endl;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+// Бенчмарк размещения узлов AST в арене
+// Разбирает сгенерированную программу размером около 10 МБ и выводит
+// счётчики арены и число выделений памяти в куче при разборе и освобождении
+void RunArenaBenchmark();
@@ -0,0 +1,104 @@
+#include "BatchBenchmark.h"
+
+# include "Interpreter.h"
+# include "Parallel.h"
+# include "ProgramGenerator.h"
+# include <chrono>
+# include <iostream>
+# include <memory>
+# include <string>
+# include <vector>
+
+namespace
+{
+	// Пакет из небольших программ разной длительности
+	// Каждая четвёртая программа - длинный текст, который выполняется быстро,
+	// на ней основное время уходит на разбор
+	std::vector<std::string> MakeBatch(size_t count)
+	{
+		auto large = GenerateProgram(16 * 1024);
+		std::vector<std::string> programs;
+		for (size_t i = 0; i < count; i++)
+		{
+			auto n = std::to_string(i % 7 + 10);
+			switch (i % 4)
+			{
+				case 0:
+					programs.push_back(
+						"(let fib = (function n (if (var n) (val -2) then (val 1)"
+						" else (add (call (var fib) (add (var n) (val 1))) (call (var fib) (add (var n) (val 2))))))"
+						" in (call (var fib) (val -" + n + ")))");
+					break;
+				case 1:
+					programs.push_back(
+						"(let loop = (function n (if (var n) (val " + n + "00) then (var n)"
+						" else (call (var loop) (add (var n) (val 1)))))"
+						" in (call (var loop) (val 0)))");
+					break;
+				case 2:
+					programs.push_back(
+						"(let x = (val 0) in (block (set x (add (var x) (val " + n + ")))"
+						" (let f = (function y (add (var x) (var y))) in (call (var f) (val 1)))))");
+					break;
+				default:
+					programs.push_back(large);
+					break;
+			}
+		}
+		return programs;
+	}
+
+	// Выполнить пакет на threads потоках, вернуть время, мс
+	// cacheSize - объём кэша программ, 0 - без кэша
+	double RunPrograms(const std::vector<std::string>& programs, size_t threads, size_t cacheSize, size_t& failed)
+	{
+		auto begin = std::chrono::steady_clock::now();
+		SymbolTable symbols;
+		std::unique_ptr<ProgramCache> cache;
+		if (cacheSize > 0) cache = std::make_unique<ProgramCache>(cacheSize);
+		std::vector<std::unique_ptr<Interpreter>> interpreters(threads);
+		std::vector<char> succeeded(programs.size());
+		ParallelFor(programs.size(), threads, [&](size_t worker, size_t index)
+		{
+			if (!interpreters[worker])
+				interpreters[worker] = std::make_unique<Interpreter>(symbols, InterpreterOptions(), cache.get());
+			succeeded[index] = interpreters[worker]->Run(programs[index]).succeeded;
+		});
+		interpreters.clear();
+		auto end = std::chrono::steady_clock::now();
+
+		failed = 0;
+		for (auto ok : succeeded)
+		{
+			if (!ok) failed++;
+		}
+		return std::chrono::duration<double, std::milli>(end - begin).count();
+	}
+}
+
+void RunBatchBenchmark()
+{
+	auto programs = MakeBatch(3000);
+	size_t cores = GetDefaultThreadCount();
+	std::cout << "Batch benchmark (" << programs.size() << " programs, " << cores << " cores)" << std::endl;
+
+	// Сначала без кэша, затем с кэшем программ,
+	// в котором помещаются все различные программы пакета
+	double single = 0;
+	for (size_t cacheSize : { (size_t)0, (size_t)16 * 1024 * 1024 })
+	{
+		for (size_t threads = 1; ; threads *= 2)
+		{
+			if (threads > cores) threads = cores;
+			size_t failed;
+			double time = RunPrograms(programs, threads, cacheSize, failed);
+			if (threads == 1 && cacheSize == 0) single = time;
+			std::cout << threads << " threads" << (cacheSize ? ", cached: " : ": ") << time << " ms, "
+				<< programs.size() * 1000.0 / time << " programs/s, "
+				<< "speedup " << single / time;
+			if (failed) std::cout << ", " << failed << " failed";
+			std::cout << std::endl;
+			if (threads == cores) break;
+		}
+	}
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// Бенчмарк пакетного выполнения
+// Выполняет пакет небольших программ на 1, 2, 4... потоках до числа ядер
+// процессора, без кэша программ и с ним, и выводит пропускную способность
+// и ускорение относительно одного потока без кэша
+void RunBatchBenchmark();
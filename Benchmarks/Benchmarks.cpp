@@ -0,0 +1,91 @@
+# include "DispatchBenchmark.h"
+# include "ArenaBenchmark.h"
+# include "LexerBenchmark.h"
+# include "ParserBenchmark.h"
+# include "TailCallBenchmark.h"
+# include "CallBenchmark.h"
+# include "ParallelEvalBenchmark.h"
+# include "SuiteBenchmark.h"
+# include "BatchBenchmark.h"
+# include "SerializationBenchmark.h"
+
+# include <iostream>
+# include <string>
+
+// Набор бенчмарков интерпретатора
+// Запуск: Benchmarks [имя бенчмарка] [каталог программ], без аргументов выполняются все
+// Программы бенчмарка suite по умолчанию читаются из каталога Programs
+
+int main(int argc, char** argv)
+{
+	std::string name = argc > 1 ? argv[1] : "all";
+	bool all = name == "all";
+	bool found = false;
+
+	if (all || name == "dispatch")
+	{
+		RunDispatchBenchmark();
+		found = true;
+	}
+
+	if (all || name == "arena")
+	{
+		RunArenaBenchmark();
+		found = true;
+	}
+
+	if (all || name == "lexer")
+	{
+		RunLexerBenchmark();
+		found = true;
+	}
+
+	if (all || name == "parser")
+	{
+		RunParserBenchmark();
+		found = true;
+	}
+
+	if (all || name == "tailcall")
+	{
+		RunTailCallBenchmark();
+		found = true;
+	}
+
+	if (all || name == "calls")
+	{
+		RunCallBenchmark();
+		found = true;
+	}
+
+	if (all || name == "parallel")
+	{
+		RunParallelEvalBenchmark();
+		found = true;
+	}
+
+	if (all || name == "suite")
+	{
+		RunSuiteBenchmark(argc > 2 ? argv[2] : "Programs");
+		found = true;
+	}
+
+	if (all || name == "batch")
+	{
+		RunBatchBenchmark();
+		found = true;
+	}
+
+	if (all || name == "serialization")
+	{
+		RunSerializationBenchmark();
+		found = true;
+	}
+
+	if (!found)
+	{
+		std::cerr << "Unknown benchmark: " << name << std::endl;
+		return 1;
+	}
+	return 0;
+}
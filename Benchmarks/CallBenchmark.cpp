@@ -0,0 +1,83 @@
+#include "CallBenchmark.h"
+
+# include "ProgramGenerator.h"
+# include "Arena.h"
+# include "Lexer.h"
+# include "Parser.h"
+# include "Resolver.h"
+# include "Evaluator.h"
+# include "Bytecode.h"
+# include "VirtualMachine.h"
+# include "ThunkExecutor.h"
+# include "Exceptions.h"
+# include <chrono>
+# include <iostream>
+# include <sstream>
+# include <string>
+
+namespace
+{
+	// Число вызовов fib при вычислении fib(n)
+	long long CallCount(int n)
+	{
+		long long a = 1, b = 1; // calls(0), calls(1)
+		for (int i = 2; i <= n; i++)
+		{
+			long long c = a + b + 1;
+			a = b;
+			b = c;
+		}
+		return n == 0 ? a : b;
+	}
+
+	void Report(const char* name, const Value& result, double milliseconds, long long calls)
+	{
+		std::cout << name << ": " << result.ToString() << ", "
+			<< milliseconds << " ms, "
+			<< milliseconds * 1e6 / calls << " ns/call" << std::endl;
+	}
+}
+
+void RunCallBenchmark()
+{
+	const int n = 27;
+	long long calls = CallCount(n);
+
+	std::istringstream in(GenerateFibonacci(n));
+	std::cout << "Call benchmark (fib " << n << ", " << calls << " calls)" << std::endl;
+
+	SymbolTable symbols;
+	Arena arena;
+	Lexer lexer(symbols, in);
+	Parser parser(lexer, arena);
+	auto expr = parser.Parse();
+	Resolver resolver;
+	resolver.Resolve(expr);
+
+	try {
+		auto begin = std::chrono::steady_clock::now();
+		Evaluator evaluator;
+		auto result = evaluator.Eval(expr);
+		auto end = std::chrono::steady_clock::now();
+		Report("evaluator", result, std::chrono::duration<double, std::milli>(end - begin).count(), calls);
+
+		Compiler compiler;
+		auto program = compiler.Compile(expr);
+		begin = std::chrono::steady_clock::now();
+		VirtualMachine vm;
+		result = vm.Run(program);
+		end = std::chrono::steady_clock::now();
+		Report("vm", result, std::chrono::duration<double, std::milli>(end - begin).count(), calls);
+
+		auto thunks = ThunkCompiler().Compile(expr);
+		begin = std::chrono::steady_clock::now();
+		ThunkExecutor executor;
+		result = executor.Run(*thunks);
+		end = std::chrono::steady_clock::now();
+		Report("thunks", result, std::chrono::duration<double, std::milli>(end - begin).count(), calls);
+	}
+	catch (InterpreterException& e)
+	{
+		std::cout << "ERROR " << e.What() << std::endl;
+	}
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+// Бенчмарк вызовов функций
+// Вычисляет числа Фибоначчи рекурсивной функцией на Evaluator,
+// VirtualMachine и ThunkExecutor и выводит время одного вызова
+void RunCallBenchmark();
@@ -0,0 +1,196 @@
+#include "DispatchBenchmark.h"
+
+# include "AST.h"
+# include <chrono>
+# include <iostream>
+# include <string>
+# include <vector>
+
+namespace
+{
+	const PositionInText position(1, 0);
+
+	// Глубокое дерево из вложенных (add <tree> (val 1))
+	Expression* BuildAddTree(Arena& arena, int depth)
+	{
+		Expression* tree = arena.Create<ValExpression>(0, position);
+		for (int i = 0; i < depth; i++)
+			tree = arena.Create<AddExpression>(tree, arena.Create<ValExpression>(1, position), position);
+		return tree;
+	}
+
+	// Глубокое дерево из вложенных (if (val 1) (val 0) then <tree> else (val 0))
+	Expression* BuildIfTree(Arena& arena, int depth)
+	{
+		Expression* tree = arena.Create<ValExpression>(0, position);
+		for (int i = 0; i < depth; i++)
+			tree = arena.Create<IfExpression>(
+				arena.Create<ValExpression>(1, position), arena.Create<ValExpression>(0, position),
+				tree, arena.Create<ValExpression>(0, position), position);
+		return tree;
+	}
+
+	// Глубокое дерево из вложенных (call (function x <tree>) (val 1))
+	Expression* BuildCallTree(Arena& arena, SymbolTable& symbols, int depth)
+	{
+		Symbol arg = symbols.Intern("x");
+		Expression* tree = arena.Create<VarExpression>(arg, position);
+		for (int i = 0; i < depth; i++)
+			tree = arena.Create<CallExpression>(
+				arena.Create<FunctionExpression>(arg, tree, position),
+				arena.Create<ValExpression>(1, position), position);
+		return tree;
+	}
+
+	// Добавить в стэк обхода дочерние узлы
+	// Выбор типа узла - цепочка dynamic_cast, как в прежнем Evaluator::Eval
+	void PushChildrenByCast(Expression* expr, std::vector<Expression*>& stack)
+	{
+		if (dynamic_cast<ValExpression*>(expr) != nullptr)
+			return;
+		if (dynamic_cast<VarExpression*>(expr) != nullptr)
+			return;
+		if (auto addExpr = dynamic_cast<AddExpression*>(expr))
+		{
+			stack.push_back(addExpr->GetLeftOperand());
+			stack.push_back(addExpr->GetRightOperand());
+			return;
+		}
+		if (auto ifExpr = dynamic_cast<IfExpression*>(expr))
+		{
+			stack.push_back(ifExpr->GetLeftOperand());
+			stack.push_back(ifExpr->GetRightOperand());
+			stack.push_back(ifExpr->GetThenBranch());
+			stack.push_back(ifExpr->GetElseBranch());
+			return;
+		}
+		if (auto letExpr = dynamic_cast<LetExpression*>(expr))
+		{
+			stack.push_back(letExpr->GetExpression());
+			stack.push_back(letExpr->GetBody());
+			return;
+		}
+		if (auto funcExpr = dynamic_cast<FunctionExpression*>(expr))
+		{
+			stack.push_back(funcExpr->GetBody());
+			return;
+		}
+		if (auto callExpr = dynamic_cast<CallExpression*>(expr))
+		{
+			stack.push_back(callExpr->GetCallable());
+			stack.push_back(callExpr->GetArgument());
+			return;
+		}
+		if (auto setExpr = dynamic_cast<SetExpression*>(expr))
+		{
+			stack.push_back(setExpr->GetExpression());
+			return;
+		}
+		if (auto blockExpr = dynamic_cast<BlockExpression*>(expr))
+		{
+			for (auto nested : blockExpr->GetExpressions())
+				stack.push_back(nested);
+		}
+	}
+
+	// Добавить в стэк обхода дочерние узлы
+	// Выбор типа узла - switch по метке ExpressionKind
+	void PushChildrenByKind(Expression* expr, std::vector<Expression*>& stack)
+	{
+		switch (expr->GetKind())
+		{
+			case ExpressionKind::Add:
+			{
+				auto addExpr = static_cast<AddExpression*>(expr);
+				stack.push_back(addExpr->GetLeftOperand());
+				stack.push_back(addExpr->GetRightOperand());
+				break;
+			}
+			case ExpressionKind::If:
+			{
+				auto ifExpr = static_cast<IfExpression*>(expr);
+				stack.push_back(ifExpr->GetLeftOperand());
+				stack.push_back(ifExpr->GetRightOperand());
+				stack.push_back(ifExpr->GetThenBranch());
+				stack.push_back(ifExpr->GetElseBranch());
+				break;
+			}
+			case ExpressionKind::Let:
+			{
+				auto letExpr = static_cast<LetExpression*>(expr);
+				stack.push_back(letExpr->GetExpression());
+				stack.push_back(letExpr->GetBody());
+				break;
+			}
+			case ExpressionKind::Function:
+				stack.push_back(static_cast<FunctionExpression*>(expr)->GetBody());
+				break;
+			case ExpressionKind::Call:
+			{
+				auto callExpr = static_cast<CallExpression*>(expr);
+				stack.push_back(callExpr->GetCallable());
+				stack.push_back(callExpr->GetArgument());
+				break;
+			}
+			case ExpressionKind::Set:
+				stack.push_back(static_cast<SetExpression*>(expr)->GetExpression());
+				break;
+			case ExpressionKind::Block:
+				for (auto nested : static_cast<BlockExpression*>(expr)->GetExpressions())
+					stack.push_back(nested);
+				break;
+			default:
+				break;
+		}
+	}
+
+	// Обойти дерево iterations раз с заданным способом диспетчеризации
+	// Возвращает среднее время обработки одного узла в наносекундах
+	template<class Dispatch>
+	double MeasureDispatch(Expression* tree, int iterations, Dispatch dispatch)
+	{
+		std::vector<Expression*> stack;
+		size_t nodes = 0;
+		auto begin = std::chrono::steady_clock::now();
+		for (int i = 0; i < iterations; i++)
+		{
+			stack.push_back(tree);
+			while (!stack.empty())
+			{
+				auto expr = stack.back();
+				stack.pop_back();
+				dispatch(expr, stack);
+				nodes++;
+			}
+		}
+		auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::nano>(end - begin).count() / nodes;
+	}
+
+	void Report(const std::string& name, Expression* tree, int iterations)
+	{
+		double byCast = MeasureDispatch(tree, iterations, PushChildrenByCast);
+		double byKind = MeasureDispatch(tree, iterations, PushChildrenByKind);
+		std::cout << name
+			<< ": dynamic_cast " << byCast << " ns/node"
+			<< ", kind switch " << byKind << " ns/node"
+			<< ", speedup x" << (byKind > 0 ? byCast / byKind : 0) << std::endl;
+	}
+}
+
+void RunDispatchBenchmark()
+{
+	const int depth = 100000;
+	const int iterations = 50;
+
+	SymbolTable symbols;
+	Arena arena;
+	Expression* addTree = BuildAddTree(arena, depth);
+	Expression* ifTree = BuildIfTree(arena, depth);
+	Expression* callTree = BuildCallTree(arena, symbols, depth);
+
+	std::cout << "Dispatch benchmark (depth " << depth << ", " << iterations << " passes)" << std::endl;
+	Report("add ", addTree, iterations);
+	Report("if  ", ifTree, iterations);
+	Report("call", callTree, iterations);
+}
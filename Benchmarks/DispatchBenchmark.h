@@ -0,0 +1,6 @@
+#pragma once
+
+// Микробенчмарк диспетчеризации узлов AST
+// Сравнивает выбор обработчика узла цепочкой dynamic_cast
+// (так исполнитель работал раньше) и переключением по ExpressionKind
+void RunDispatchBenchmark();
@@ -0,0 +1,70 @@
+#include "LexerBenchmark.h"
+
+# include "ProgramGenerator.h"
+# include "Lexer.h"
+# include "BufferLexer.h"
+# include "ParallelLexer.h"
+# include "Parallel.h"
+# include <chrono>
+# include <iostream>
+# include <sstream>
+# include <string>
+
+namespace
+{
+	// Прочитать все лексемы потока и вывести скорость чтения
+	void Measure(const std::string& name, TokenStream& lexer, size_t size)
+	{
+		size_t tokens = 0;
+		auto begin = std::chrono::steady_clock::now();
+		while (lexer.Next()) tokens++;
+		auto end = std::chrono::steady_clock::now();
+
+		double seconds = std::chrono::duration<double>(end - begin).count();
+		std::cout << name << ": " << tokens << " tokens, "
+			<< seconds * 1000 << " ms, "
+			<< size / seconds / (1024 * 1024) << " MB/s" << std::endl;
+	}
+}
+
+void RunLexerBenchmark()
+{
+	SymbolTable symbols;
+
+	auto source = GenerateProgram(10 * 1024 * 1024);
+	std::cout << "Lexer benchmark (" << source.size() << " bytes of source)" << std::endl;
+
+	std::istringstream in(source);
+	Lexer streamLexer(symbols, in);
+	Measure("stream", streamLexer, source.size());
+
+	for (auto scanner : GetCharScanners())
+	{
+		BufferLexer bufferLexer(symbols, source.data(), source.data() + source.size());
+		bufferLexer.SetScanner(*scanner);
+		Measure(std::string("buffer (") + scanner->name + ")", bufferLexer, source.size());
+	}
+
+	// Параллельное чтение: время разбиения и чтения частей на потоках
+	// и время выдачи лексем по одной, которая остаётся последовательной
+	size_t cores = GetDefaultThreadCount();
+	double single = 0;
+	for (size_t threads = 1; ; threads *= 2)
+	{
+		if (threads > cores) threads = cores;
+		auto begin = std::chrono::steady_clock::now();
+		ParallelLexer lexer(symbols, source.data(), source.data() + source.size(), threads);
+		auto scanned = std::chrono::steady_clock::now();
+		size_t tokens = 0;
+		while (lexer.Next()) tokens++;
+		auto end = std::chrono::steady_clock::now();
+
+		double scan = std::chrono::duration<double, std::milli>(scanned - begin).count();
+		double total = std::chrono::duration<double, std::milli>(end - begin).count();
+		if (threads == 1) single = total;
+		std::cout << "parallel, " << threads << " threads (" << lexer.GetChunkCount() << " chunks): "
+			<< tokens << " tokens, " << total << " ms (scan " << scan << " ms), "
+			<< source.size() / total * 1000 / (1024 * 1024) << " MB/s, speedup " << single / total << std::endl;
+		if (threads == cores) break;
+	}
+}
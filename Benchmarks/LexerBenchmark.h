@@ -0,0 +1,7 @@
+#pragma once
+
+// Бенчмарк пропускной способности лексических анализаторов
+// Читает сгенерированную программу потоковым Lexer, BufferLexer
+// с каждой реализацией CharScanner, поддерживаемой процессором,
+// и ParallelLexer на 1, 2, 4... потоках до числа ядер и выводит скорость в МБ/с
+void RunLexerBenchmark();
@@ -0,0 +1,62 @@
+#include "ParallelEvalBenchmark.h"
+
+# include "ProgramGenerator.h"
+# include "Arena.h"
+# include "Lexer.h"
+# include "Parser.h"
+# include "Resolver.h"
+# include "PurityAnalyzer.h"
+# include "Evaluator.h"
+# include "Parallel.h"
+# include "Exceptions.h"
+# include <chrono>
+# include <iostream>
+# include <memory>
+# include <sstream>
+# include <string>
+
+void RunParallelEvalBenchmark()
+{
+	const int n = 30;
+	std::istringstream in(GenerateFibonacci(n));
+	std::cout << "Parallel evaluation benchmark (fib " << n << ")" << std::endl;
+
+	SymbolTable symbols;
+	Arena arena;
+	Lexer lexer(symbols, in);
+	Parser parser(lexer, arena);
+	auto expr = parser.Parse();
+	Resolver resolver;
+	resolver.Resolve(expr);
+	PurityAnalyzer analyzer;
+	analyzer.Analyze(expr);
+
+	try {
+		// Без пула отмеченные операнды вычисляются последовательно
+		auto begin = std::chrono::steady_clock::now();
+		Evaluator sequential;
+		auto expected = sequential.Eval(expr).ToString();
+		double single = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+		std::cout << "sequential: " << expected << ", " << single << " ms" << std::endl;
+
+		size_t cores = GetDefaultThreadCount();
+		for (size_t threads = 1; ; threads *= 2)
+		{
+			if (threads > cores) threads = cores;
+			begin = std::chrono::steady_clock::now();
+			TaskPool pool(threads);
+			Evaluator evaluator;
+			evaluator.SetTaskPool(&pool);
+			auto result = evaluator.Eval(expr).ToString();
+			double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+			std::cout << "parallel, " << threads << " threads: " << result << ", " << time << " ms, speedup "
+				<< single / time << (result == expected ? "" : ", result differs") << std::endl;
+			if (threads == cores) break;
+		}
+	}
+	catch (InterpreterException& e)
+	{
+		std::cout << "ERROR: " << e.What() << std::endl;
+	}
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+// Бенчмарк параллельного вычисления операндов
+// Выполняет fib на Evaluator последовательно и с пулом из 1, 2, 4...
+// потоков до числа ядер, выводит время, ускорение и проверяет результат
+void RunParallelEvalBenchmark();
@@ -0,0 +1,49 @@
+#include "ParserBenchmark.h"
+
+# include "ProgramGenerator.h"
+# include "BufferLexer.h"
+# include "Parser.h"
+# include "ParallelParser.h"
+# include "Parallel.h"
+# include "Serialization.h"
+# include <chrono>
+# include <iostream>
+# include <string>
+
+void RunParserBenchmark()
+{
+	auto source = GenerateProgram(10 * 1024 * 1024);
+	std::cout << "Parser benchmark (" << source.size() << " bytes of source)" << std::endl;
+
+	// AST сравниваются по сохранённому виду: он включает позиции узлов
+	std::string expected;
+	double sequential;
+	{
+		SymbolTable symbols;
+		Arena arena;
+		auto begin = std::chrono::steady_clock::now();
+		BufferLexer lexer(symbols, source.data(), source.data() + source.size());
+		Parser parser(lexer, arena);
+		auto expr = parser.Parse();
+		sequential = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+		expected = SerializeProgram(expr);
+		std::cout << "sequential: " << parser.GetStats().nodes << " nodes, " << sequential << " ms" << std::endl;
+	}
+
+	size_t cores = GetDefaultThreadCount();
+	for (size_t threads = 1; ; threads *= 2)
+	{
+		if (threads > cores) threads = cores;
+		SymbolTable symbols;
+		Arena arena;
+		auto begin = std::chrono::steady_clock::now();
+		ParallelParser parser(symbols, arena, threads);
+		auto expr = parser.Parse(source.data(), source.data() + source.size());
+		double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+		std::cout << "parallel, " << threads << " threads (" << parser.GetGroupCount() << " groups): "
+			<< parser.GetStats().nodes << " nodes, " << time << " ms, speedup " << sequential / time
+			<< (SerializeProgram(expr) == expected ? "" : ", AST differs") << std::endl;
+		if (threads == cores) break;
+	}
+}
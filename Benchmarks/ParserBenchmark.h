@@ -0,0 +1,7 @@
+#pragma once
+
+// Бенчмарк параллельного синтаксического анализа
+// Разбирает сгенерированную программу последовательно и ParallelParser
+// на 1, 2, 4... потоках до числа ядер, выводит время и ускорение
+// и проверяет, что AST совпадает с последовательным разбором
+void RunParserBenchmark();
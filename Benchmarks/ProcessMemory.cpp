@@ -0,0 +1,37 @@
+#include "ProcessMemory.h"
+
+#ifdef _WIN32
+# define NOMINMAX
+# include <windows.h>
+# include <psapi.h>
+# pragma comment(lib, "psapi.lib")
+#else
+# include <sys/resource.h>
+#endif
+
+#ifdef _WIN32
+
+size_t GetPeakMemory()
+{
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return 0;
+	return counters.PeakWorkingSetSize;
+}
+
+#else
+
+size_t GetPeakMemory()
+{
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#ifdef __APPLE__
+	// На macOS ru_maxrss измеряется в байтах, на Linux - в килобайтах
+	return (size_t)usage.ru_maxrss;
+#else
+	return (size_t)usage.ru_maxrss * 1024;
+#endif
+}
+
+#endif
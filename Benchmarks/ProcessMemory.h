@@ -0,0 +1,8 @@
+#pragma once
+
+# include <cstddef>
+
+// Пиковый объём физической памяти процесса (peak RSS) в байтах
+// Значение только растёт, поэтому после тяжёлой программы
+// оно не уменьшится для следующих
+size_t GetPeakMemory();
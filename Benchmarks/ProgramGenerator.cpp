@@ -0,0 +1,53 @@
+#include "ProgramGenerator.h"
+
+std::string GenerateProgram(size_t size)
+{
+	std::string program = "(block\n";
+	for (size_t i = 0; program.size() < size; i++)
+	{
+		auto n = std::to_string(i);
+		program += "  (let x" + n + " = (val " + n + ") in\n"
+			"    (if (var x" + n + ") (val 100)\n"
+			"      then (call (function y (add (var y) (val -1))) (var x" + n + "))\n"
+			"      else (block (set x" + n + " (add (var x" + n + ") (val 1))) (var x" + n + "))))\n";
+	}
+	program += ")\n";
+	return program;
+}
+
+std::string GenerateDeepLet(size_t depth)
+{
+	std::string program = "(let x0 = (val 0) in\n";
+	for (size_t i = 1; i <= depth; i++)
+	{
+		program += "(let x" + std::to_string(i) + " = (add (var x" + std::to_string(i - 1) + ") (val 1)) in\n";
+	}
+	program += "(var x" + std::to_string(depth) + ")";
+	program += std::string(depth + 1, ')');
+	program += "\n";
+	return program;
+}
+
+// В языке нет вычитания, поэтому n передаётся отрицательным
+// и увеличивается к -1 и 0
+std::string GenerateFibonacci(int n)
+{
+	return
+		"(let fib = (function n"
+		"  (if (var n) (val -2)"
+		"   then (val 1)"
+		"   else (add (call (var fib) (add (var n) (val 1)))"
+		"             (call (var fib) (add (var n) (val 2))))))"
+		" in (call (var fib) (val " + std::to_string(-n) + ")))";
+}
+
+std::string GenerateSetBlock(size_t count)
+{
+	std::string program = "(let x = (val 0) in (block\n";
+	for (size_t i = 0; i < count; i++)
+	{
+		program += "  (set x (add (var x) (val 1)))\n";
+	}
+	program += "  (var x)))\n";
+	return program;
+}
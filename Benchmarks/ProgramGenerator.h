@@ -0,0 +1,22 @@
+#pragma once
+
+# include <cstddef>
+# include <string>
+
+// Генератор больших программ на DL для бенчмарков лексического
+// и синтаксического анализаторов
+// Программа - один блок из множества независимых выражений с let, add, if,
+// function и call, общий размер текста - не меньше size байт
+std::string GenerateProgram(size_t size);
+
+// Глубоко вложенные <let>: каждая из depth переменных
+// вычисляется через предыдущую, результат - (val depth)
+std::string GenerateDeepLet(size_t depth);
+
+// Числа Фибоначчи: fib(n) = 1 при n < 2, иначе fib(n - 1) + fib(n - 2),
+// результат - (val fib(n))
+std::string GenerateFibonacci(int n);
+
+// Длинный блок из count выражений <set>, увеличивающих одну переменную,
+// результат - (val count)
+std::string GenerateSetBlock(size_t count);
@@ -0,0 +1,63 @@
+#include "SerializationBenchmark.h"
+
+# include "ProgramGenerator.h"
+# include "BufferLexer.h"
+# include "Parser.h"
+# include "Serialization.h"
+# include <chrono>
+# include <iostream>
+# include <string>
+
+namespace
+{
+	const int REPEATS = 5;
+
+	// Лучшее из нескольких повторений время, мс
+	template<class Function> double Measure(Function function)
+	{
+		double best = 0;
+		for (int i = 0; i < REPEATS; i++)
+		{
+			auto begin = std::chrono::steady_clock::now();
+			function();
+			double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+			if (i == 0 || time < best) best = time;
+		}
+		return best;
+	}
+}
+
+void RunSerializationBenchmark()
+{
+	auto source = GenerateProgram(10 * 1024 * 1024);
+
+	std::string serialized;
+	{
+		SymbolTable symbols;
+		Arena arena;
+		BufferLexer lexer(symbols, source.data(), source.data() + source.size());
+		Parser parser(lexer, arena);
+		serialized = SerializeProgram(parser.Parse());
+	}
+	std::cout << "Serialization benchmark (" << source.size() << " bytes of source, "
+		<< serialized.size() << " bytes of AST)" << std::endl;
+
+	// Каждое повторение начинается с пустой таблицы символов и арены
+	double parseTime = Measure([&]()
+	{
+		SymbolTable symbols;
+		Arena arena;
+		BufferLexer lexer(symbols, source.data(), source.data() + source.size());
+		Parser parser(lexer, arena);
+		parser.Parse();
+	});
+	double loadTime = Measure([&]()
+	{
+		SymbolTable symbols;
+		Arena arena;
+		DeserializeProgram(serialized.data(), serialized.size(), arena, symbols);
+	});
+
+	std::cout << "parse: " << parseTime << " ms" << std::endl;
+	std::cout << "load: " << loadTime << " ms (" << parseTime / loadTime << "x)" << std::endl;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+// Бенчмарк двоичного формата AST
+// Сравнивает синтаксический анализ большой программы с загрузкой
+// её сохранённого AST и выводит время и размеры текста и файла
+void RunSerializationBenchmark();
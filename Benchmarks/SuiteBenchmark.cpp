@@ -0,0 +1,144 @@
+#include "SuiteBenchmark.h"
+
+# include "AllocationCounter.h"
+# include "ProcessMemory.h"
+# include "ProgramGenerator.h"
+# include "Arena.h"
+# include "BufferLexer.h"
+# include "Parser.h"
+# include "Resolver.h"
+# include "Optimizer.h"
+# include "Evaluator.h"
+# include "Exceptions.h"
+# include <algorithm>
+# include <chrono>
+# include <filesystem>
+# include <fstream>
+# include <iomanip>
+# include <iostream>
+# include <sstream>
+# include <string>
+# include <utility>
+# include <vector>
+
+namespace
+{
+	// Программа набора: имя и текст
+	struct Program
+	{
+		std::string name;
+		std::string source;
+	};
+
+	// Замер одного этапа: время и выделения памяти в куче
+	class Phase
+	{
+		std::chrono::steady_clock::time_point begin;
+		AllocationCount allocations;
+	public:
+		Phase() : begin(std::chrono::steady_clock::now()), allocations(GetAllocationCount())
+		{
+		}
+
+		// Вывести строку таблицы с результатами этапа
+		void Report(const char* name) const
+		{
+			auto end = std::chrono::steady_clock::now();
+			auto count = GetAllocationCount() - allocations;
+			std::cout << "  " << std::left << std::setw(10) << name << std::right
+				<< std::setw(12) << std::fixed << std::setprecision(3)
+				<< std::chrono::duration<double, std::milli>(end - begin).count() << " ms"
+				<< std::setw(12) << count.allocations << " allocs"
+				<< std::setw(14) << count.bytes << " bytes" << std::endl;
+		}
+	};
+
+	// Прочитать программы .dl каталога в порядке имён файлов
+	std::vector<Program> LoadPrograms(const std::string& directory)
+	{
+		std::vector<Program> programs;
+		std::error_code error;
+		for (auto& entry : std::filesystem::directory_iterator(directory, error))
+		{
+			if (entry.path().extension() != ".dl") continue;
+			std::ifstream in(entry.path(), std::ios::binary);
+			std::ostringstream source;
+			source << in.rdbuf();
+			programs.push_back({ entry.path().filename().string(), source.str() });
+		}
+		if (error)
+			std::cerr << "Can't read " << directory << ": " << error.message() << std::endl;
+		std::sort(programs.begin(), programs.end(),
+			[](const Program& a, const Program& b) { return a.name < b.name; });
+		return programs;
+	}
+
+	// Прочитать все лексемы текста
+	size_t Tokenize(SymbolTable& symbols, const std::string& source)
+	{
+		BufferLexer lexer(symbols, source.data(), source.data() + source.size());
+		size_t tokens = 0;
+		while (lexer.Next()) tokens++;
+		return tokens;
+	}
+
+	// Выполнить программу по этапам и вывести замеры каждого
+	void Run(const Program& program)
+	{
+		std::cout << program.name << " (" << program.source.size() << " bytes)" << std::endl;
+
+		SymbolTable symbols;
+		Arena arena;
+		try {
+			Phase lex;
+			auto tokens = Tokenize(symbols, program.source);
+			lex.Report("lex");
+
+			// Синтаксический анализатор читает лексемы по мере разбора,
+			// поэтому время этого этапа включает и лексический анализ
+			Phase parse;
+			BufferLexer lexer(symbols, program.source.data(), program.source.data() + program.source.size());
+			Parser parser(lexer, arena);
+			auto expr = parser.Parse();
+			parse.Report("parse");
+
+			Phase resolve;
+			Resolver resolver;
+			resolver.Resolve(expr);
+			Optimizer optimizer(arena);
+			expr = optimizer.Optimize(expr);
+			resolver.Resolve(expr);
+			resolve.Report("resolve");
+
+			Phase eval;
+			Value result;
+			{
+				Evaluator evaluator;
+				result = evaluator.Eval(expr);
+			}
+			eval.Report("eval");
+
+			std::cout << "  " << tokens << " tokens, result " << result.ToString() << std::endl;
+		}
+		catch (InterpreterException& e)
+		{
+			std::cout << "  ERROR " << e.What() << std::endl;
+		}
+
+		std::cout << "  peak memory " << GetPeakMemory() / 1024 << " KB" << std::endl;
+	}
+}
+
+void RunSuiteBenchmark(const std::string& directory)
+{
+	auto programs = LoadPrograms(directory);
+	programs.push_back({ "generated: deep let", GenerateDeepLet(1000) });
+	programs.push_back({ "generated: set block", GenerateSetBlock(100000) });
+	programs.push_back({ "generated: large program", GenerateProgram(4 * 1024 * 1024) });
+
+	std::cout << "Suite benchmark (" << programs.size() << " programs)" << std::endl;
+	for (auto& program : programs)
+	{
+		Run(program);
+	}
+}
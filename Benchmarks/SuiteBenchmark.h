@@ -0,0 +1,12 @@
+#pragma once
+
+# include <string>
+
+// Набор характерных программ на DL
+// Выполняет каждую программу .dl из каталога directory, а также
+// сгенерированные программы (глубоко вложенные <let>, длинный блок <set>,
+// большой текст для анализаторов) и для каждой по отдельности выводит
+// время, число выделений памяти и объём выделенной памяти на этапах
+// лексического анализа, синтаксического анализа, разрешения имён и выполнения,
+// а также пиковый объём памяти процесса после её выполнения
+void RunSuiteBenchmark(const std::string& directory);
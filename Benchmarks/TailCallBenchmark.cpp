@@ -0,0 +1,51 @@
+#include "TailCallBenchmark.h"
+
+# include "Arena.h"
+# include "Lexer.h"
+# include "Parser.h"
+# include "Resolver.h"
+# include "Evaluator.h"
+# include "Exceptions.h"
+# include <chrono>
+# include <iostream>
+# include <sstream>
+# include <string>
+
+void RunTailCallBenchmark()
+{
+	const int iterations = 1000000;
+
+	// Счётчик: функция вызывает себя в хвостовой позиции ветви <if>,
+	// пока n не превысит iterations - 1
+	std::istringstream in(
+		"(let loop = (function n"
+		"  (if (var n) (val " + std::to_string(iterations - 1) + ")"
+		"   then (var n)"
+		"   else (call (var loop) (add (var n) (val 1)))))"
+		" in (call (var loop) (val 0)))");
+
+	std::cout << "Tail call benchmark (" << iterations << " iterations)" << std::endl;
+
+	SymbolTable symbols;
+	Arena arena;
+	Lexer lexer(symbols, in);
+	Parser parser(lexer, arena);
+	auto expr = parser.Parse();
+	Resolver resolver;
+	resolver.Resolve(expr);
+
+	try {
+		auto begin = std::chrono::steady_clock::now();
+		Evaluator evaluator;
+		auto result = evaluator.Eval(expr);
+		auto end = std::chrono::steady_clock::now();
+
+		bool correct = result.GetType() == ValueType::Integer && result.GetInteger() == iterations;
+		std::cout << "evaluator: " << result.ToString() << (correct ? "" : " (WRONG)") << ", "
+			<< std::chrono::duration<double, std::milli>(end - begin).count() << " ms" << std::endl;
+	}
+	catch (InterpreterException& e)
+	{
+		std::cout << "evaluator: ERROR " << e.What() << std::endl;
+	}
+}
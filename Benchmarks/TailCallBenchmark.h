@@ -0,0 +1,7 @@
+#pragma once
+
+// Бенчмарк хвостовых вызовов в Evaluator
+// Выполняет счётчик на миллион итераций, записанный как хвостовая рекурсия,
+// и проверяет результат. Без устранения хвостовых вызовов
+// такая программа переполняет стэк C++
+void RunTailCallBenchmark();
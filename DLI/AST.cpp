@@ -1,11 +1,5 @@
 #include "AST.h"
 
-AddExpression::~AddExpression()
-{
-	delete left;
-	delete right;
-}
-
 Expression* AddExpression::GetLeftOperand() const
 {
 	return left;
@@ -16,24 +10,11 @@ Expression* AddExpression::GetRightOperand() const
 	return right;
 }
 
-Expression* AddExpression::Clone()
-{
-	return (Expression*) new AddExpression(left->Clone(), right->Clone(), GetPosition());
-}
-
 std::string AddExpression::ToString()
 {
 	return "(add " + left->ToString() + " " + right->ToString() + ")";
 }
 
-IfExpression::~IfExpression()
-{
-	delete left;
-	delete right;
-	delete thenBranch;
-	delete elseBranch;
-}
-
 Expression* IfExpression::GetLeftOperand() const
 {
 	return left;
@@ -54,29 +35,12 @@ Expression* IfExpression::GetElseBranch() const
 	return elseBranch;
 }
 
-Expression* IfExpression::Clone()
-{
-	return (Expression*)new IfExpression(
-		left->Clone(),
-		right->Clone(),
-		thenBranch->Clone(),
-		elseBranch->Clone(),
-		GetPosition()
-	);
-}
-
 std::string IfExpression::ToString()
 {
 	return "(if " + left->ToString() + " " + right->ToString() + " then " + thenBranch->ToString() + " else " + elseBranch->ToString() + ")";
 }
 
-LetExpression::~LetExpression()
-{
-	delete expression;
-	delete body;
-}
-
-std::string LetExpression::GetId() const
+Symbol LetExpression::GetId() const
 {
 	return id;
 }
@@ -91,22 +55,12 @@ Expression* LetExpression::GetBody() const
 	return body;
 }
 
-Expression* LetExpression::Clone()
-{
-	return (Expression*)new LetExpression(id, expression->Clone(), body->Clone(), GetPosition());
-}
-
 std::string LetExpression::ToString()
 {
-	return "(let " + id + " = " + expression->ToString() + " in " + body->ToString() + ")";
+	return "(let " + id.GetName() + " = " + expression->ToString() + " in " + body->ToString() + ")";
 }
 
-FunctionExpression::~FunctionExpression()
-{
-	delete body;
-}
-
-std::string FunctionExpression::GetArgument() const
+Symbol FunctionExpression::GetArgument() const
 {
 	return argument;
 }
@@ -116,20 +70,9 @@ Expression* FunctionExpression::GetBody() const
 	return body;
 }
 
-Expression* FunctionExpression::Clone()
-{
-	return (Expression*) new FunctionExpression(argument, body->Clone(), GetPosition());
-}
-
 std::string FunctionExpression::ToString()
 {
-	return "(function " + argument + " " + body->ToString() + ")";
-}
-
-CallExpression::~CallExpression()
-{
-	delete callable;
-	delete argument;
+	return "(function " + argument.GetName() + " " + body->ToString() + ")";
 }
 
 Expression* CallExpression::GetCallable() const
@@ -142,46 +85,16 @@ Expression* CallExpression::GetArgument() const
 	return argument;
 }
 
-Expression* CallExpression::Clone()
-{
-	return (Expression*) new CallExpression(callable->Clone(), argument->Clone(), GetPosition());
-}
-
 std::string CallExpression::ToString()
 {
 	return "(call " + callable->ToString() + " " + argument->ToString() + ")";
 }
 
-void BlockExpression::AddExpression(Expression * expr)
-{
-	expressions.push_back(expr);
-}
-
-BlockExpression::~BlockExpression()
-{
-	auto it = expressions.begin();
-	while (it != expressions.end())
-	{
-		delete *it;
-		it++;
-	}
-}
-
-std::list<Expression*> BlockExpression::GetExpressions() const
+const ExpressionList& BlockExpression::GetExpressions() const
 {
 	return expressions;
 }
 
-Expression* BlockExpression::Clone()
-{
-	auto blck = new BlockExpression(GetPosition());
-	for (auto p : expressions)
-	{
-		blck->AddExpression(p->Clone());
-	}
-	return (Expression*)blck;
-}
-
 std::string BlockExpression::ToString()
 {
 	std::string blockValues;
@@ -197,37 +110,32 @@ int ValExpression::GetValue() const
 	return value;
 }
 
-Expression* ValExpression::Clone()
-{
-	return (Expression*) new ValExpression(value, GetPosition());
-}
-
 std::string ValExpression::ToString()
 {
 	return "(val " + std::to_string(value) + ")";
 }
 
-std::string VarExpression::GetId() const
+Symbol VarExpression::GetId() const
 {
 	return id;
 }
 
-Expression* VarExpression::Clone()
+const LexicalAddress& VarExpression::GetAddress() const
 {
-	return (Expression*) new VarExpression(id, GetPosition());
+	return address;
 }
 
-std::string VarExpression::ToString()
+void VarExpression::SetAddress(const LexicalAddress& address)
 {
-	return "(var " + id + ")";
+	this->address = address;
 }
 
-SetExpression::~SetExpression()
+std::string VarExpression::ToString()
 {
-	delete expression;
+	return "(var " + id.GetName() + ")";
 }
 
-std::string SetExpression::GetId() const
+Symbol SetExpression::GetId() const
 {
 	return id;
 }
@@ -237,28 +145,24 @@ Expression* SetExpression::GetExpression() const
 	return expression;
 }
 
-Expression* SetExpression::Clone()
-{
-	return (Expression*) new SetExpression(id, expression->Clone(), GetPosition());
-}
-
-std::string SetExpression::ToString()
+const LexicalAddress& SetExpression::GetAddress() const
 {
-	return "(set " + id + " " + expression->ToString() + ")";
+	return address;
 }
 
-const PositionInText& Expression::GetPosition() const
+void SetExpression::SetAddress(const LexicalAddress& address)
 {
-	return position;
+	this->address = address;
 }
 
-Expression::~Expression()
+std::string SetExpression::ToString()
 {
+	return "(set " + id.GetName() + " " + expression->ToString() + ")";
 }
 
-Expression* Expression::Clone()
+const PositionInText& Expression::GetPosition() const
 {
-	return new Expression(GetPosition());
+	return position;
 }
 
 std::string Expression::ToString()
@@ -1,21 +1,50 @@
 #pragma once
 
 # include "Position.h"
+# include "Arena.h"
+# include "SymbolTable.h"
 # include <string>
-# include <list>
+# include <cstddef>
 
 // Классы представляющие элементы абстрактного синтаксического дерева
 // для синтаксических конструкций языка
+// Узлы размещаются в Arena и освобождаются вместе с ней,
+// поэтому узлы не удаляют дочерние узлы сами
+
+// Типы узлов AST
+// Позволяют исполнителю выбирать обработчик узла одним switch,
+// без последовательных dynamic_cast
+enum class ExpressionKind {
+	Empty,     // Пустое выражение, результат (set ...)
+	Val,       // (val <value>)
+	Var,       // (var <id>)
+	Add,       // (add <left> <right>)
+	If,        // (if <left> <right> then <then_branch> <else_branch>)
+	Let,       // (let <id> = <expression> in <body>)
+	Function,  // (function <arg> <body>)
+	Call,      // (call <callable> <argument>)
+	Block,     // (block <expressions>+)
+	Set        // (set <id> <expression>)
+};
+
+// Лексический адрес переменной, вычисляемый Resolver:
+// depth - на сколько областей видимости нужно подняться от текущей,
+// slot - номер ячейки в найденной области видимости
+struct LexicalAddress
+{
+	unsigned int depth = 0, slot = 0;
+	bool resolved = false;
+};
 
 // Базовый класс для выражений AST
 class Expression 
 {
 	PositionInText position;
+	ExpressionKind kind;
 public:
-	Expression(const PositionInText &position): position(position) {}
+	Expression(const PositionInText &position, ExpressionKind kind = ExpressionKind::Empty): position(position), kind(kind) {}
 	const PositionInText& GetPosition() const;
-	virtual ~Expression();         
-	virtual Expression* Clone();    // Создать копию узла
+	ExpressionKind GetKind() const { return kind; } // Тип узла
 	virtual std::string ToString(); // Представить узел в виде строки
 };
 
@@ -24,20 +53,21 @@ class ValExpression : public Expression
 {
 	int value;
 public:
-	ValExpression(int val, const PositionInText& position) : Expression(position), value(val) {};
+	ValExpression(int val, const PositionInText& position) : Expression(position, ExpressionKind::Val), value(val) {};
 	int GetValue() const;
-	virtual Expression* Clone();
 	virtual std::string ToString();
 };
 
 // Класс для конструкции (var <id>)
 class VarExpression : public Expression
 {
-	std::string id;
+	Symbol id;
+	LexicalAddress address;
 public:
-	VarExpression(std::string& str, const PositionInText& position) : id(str), Expression(position) {};
-	std::string GetId() const;
-	virtual Expression* Clone();
+	VarExpression(Symbol str, const PositionInText& position) : id(str), Expression(position, ExpressionKind::Var) {};
+	Symbol GetId() const;
+	const LexicalAddress& GetAddress() const;
+	void SetAddress(const LexicalAddress&);
 	virtual std::string ToString();
 };
 
@@ -46,13 +76,14 @@ class AddExpression : public Expression
 {
 	Expression * left;
 	Expression * right;
+	bool parallel = false; // Операнды можно вычислять параллельно (PurityAnalyzer)
 public:
-	AddExpression(Expression* left, Expression* right, const PositionInText& position) : left(left), right(right), Expression(position) {};
-	~AddExpression();
+	AddExpression(Expression* left, Expression* right, const PositionInText& position) : left(left), right(right), Expression(position, ExpressionKind::Add) {};
 
 	Expression * GetLeftOperand() const;
 	Expression * GetRightOperand() const;
-	virtual Expression* Clone();
+	bool IsParallel() const { return parallel; }
+	void SetParallel(bool parallel) { this->parallel = parallel; }
 	virtual std::string ToString();
 };
 
@@ -63,49 +94,46 @@ class IfExpression : public Expression
 	Expression * right;
 	Expression * thenBranch;
 	Expression * elseBranch;
+	bool parallel = false; // Операнды можно вычислять параллельно (PurityAnalyzer)
 public:
 	IfExpression(Expression* left, Expression* right, Expression* thenBranch, Expression* elseBranch, const PositionInText& position) :
-		left(left), right(right), thenBranch(thenBranch), elseBranch(elseBranch), Expression(position) {};
-	~IfExpression();
+		left(left), right(right), thenBranch(thenBranch), elseBranch(elseBranch), Expression(position, ExpressionKind::If) {};
 
 	Expression * GetLeftOperand() const;
 	Expression * GetRightOperand() const;
+	bool IsParallel() const { return parallel; }
+	void SetParallel(bool parallel) { this->parallel = parallel; }
 	Expression * GetThenBranch() const;
 	Expression * GetElseBranch() const;
-	virtual Expression* Clone();
 	virtual std::string ToString();
 };
 
 // Класс для конструкции (let <id> <expression> in <body>)
 class LetExpression : public Expression
 {
-	std::string id;
+	Symbol id;
 	Expression * expression;
 	Expression * body;
 public:
-	LetExpression(const std::string& id, Expression* expression, Expression* body, const PositionInText& position) :
-		id(id), expression(expression), body(body), Expression(position) {};
-	~LetExpression();
+	LetExpression(Symbol id, Expression* expression, Expression* body, const PositionInText& position) :
+		id(id), expression(expression), body(body), Expression(position, ExpressionKind::Let) {};
 
-	std::string GetId() const;
+	Symbol GetId() const;
 	Expression * GetExpression() const;
 	Expression * GetBody() const;
-	virtual Expression* Clone();
 	virtual std::string ToString();
 };
 
 // Класс для конструкции (function <arg> <body>)
 class FunctionExpression : public Expression
 {
-	std::string argument;
+	Symbol argument;
 	Expression * body;
 public:
-	FunctionExpression(const std::string& arg, Expression* body, const PositionInText& position) : argument(arg), body(body), Expression(position) {};
-	~FunctionExpression();
+	FunctionExpression(Symbol arg, Expression* body, const PositionInText& position) : argument(arg), body(body), Expression(position, ExpressionKind::Function) {};
 
-	std::string GetArgument() const;
+	Symbol GetArgument() const;
 	Expression * GetBody() const;
-	virtual Expression* Clone();
 	virtual std::string ToString();
 };
 
@@ -115,41 +143,50 @@ class CallExpression : public Expression
 	Expression * callable;
 	Expression * argument;
 public:
-	CallExpression(Expression* callable, Expression* argument, const PositionInText& position) : callable(callable), argument(argument), Expression(position) {};
-	~CallExpression();
+	CallExpression(Expression* callable, Expression* argument, const PositionInText& position) : callable(callable), argument(argument), Expression(position, ExpressionKind::Call) {};
 
 	Expression * GetCallable() const;
 	Expression * GetArgument() const;
-	virtual Expression* Clone();
 	virtual std::string ToString();
 };
 
+// Список вложенных выражений, размещённый в арене
+class ExpressionList
+{
+	Expression** items = nullptr;
+	size_t count = 0;
+public:
+	ExpressionList() {}
+	ExpressionList(Expression** items, size_t count) : items(items), count(count) {}
+	Expression** begin() const { return items; }
+	Expression** end() const { return items + count; }
+	size_t size() const { return count; }
+};
+
 // Класс для конструкции (block <expressions>+)
 class BlockExpression : public Expression
 {
-	std::list<Expression*> expressions;
+	ExpressionList expressions;
 public:
-	BlockExpression(const PositionInText& position) : Expression(position) {}
-	void AddExpression(Expression*);
-	~BlockExpression();
+	BlockExpression(const ExpressionList& expressions, const PositionInText& position) : expressions(expressions), Expression(position, ExpressionKind::Block) {}
 
-	std::list<Expression*> GetExpressions() const;
-	virtual Expression* Clone();
+	const ExpressionList& GetExpressions() const;
 	virtual std::string ToString();
 };
 
 // Класс для конструкции (set <id> <expression>)
 class SetExpression : public Expression
 {
-	std::string id;
+	Symbol id;
 	Expression* expression;
+	LexicalAddress address;
 public:
-	SetExpression(const std::string& id, Expression* expression, const PositionInText& position) :
-		id(id), expression(expression), Expression(position) {};
-	~SetExpression();
+	SetExpression(Symbol id, Expression* expression, const PositionInText& position) :
+		id(id), expression(expression), Expression(position, ExpressionKind::Set) {};
 
-	std::string GetId() const;
+	Symbol GetId() const;
+	const LexicalAddress& GetAddress() const;
+	void SetAddress(const LexicalAddress&);
 	Expression * GetExpression() const;
-	virtual Expression* Clone();
 	virtual std::string ToString();
 };
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "Arena.h"
+
+Arena::~Arena()
+{
+	Release();
+}
+
+// Выделить память сдвигом указателя в текущем блоке
+// Если места не хватает, берём у кучи новый блок
+void* Arena::Allocate(size_t size, size_t alignment)
+{
+	size_t padding = (alignment - reinterpret_cast<size_t>(current) % alignment) % alignment;
+	if (current == nullptr || (size_t)(limit - current) < size + padding)
+	{
+		AddBlock(size + alignment);
+		padding = (alignment - reinterpret_cast<size_t>(current) % alignment) % alignment;
+	}
+
+	char* result = current + padding;
+	current = result + size;
+	stats.objects++;
+	stats.bytes += size;
+	return result;
+}
+
+// Текущим остаётся собственный блок, свободное место в блоках other
+// не используется
+void Arena::Merge(Arena& other)
+{
+	blocks.insert(blocks.end(), other.blocks.begin(), other.blocks.end());
+	destructors.insert(destructors.end(), other.destructors.begin(), other.destructors.end());
+	stats.objects += other.stats.objects;
+	stats.bytes += other.stats.bytes;
+	stats.blocks += other.stats.blocks;
+	stats.blockBytes += other.stats.blockBytes;
+	stats.destructors += other.stats.destructors;
+
+	other.blocks.clear();
+	other.destructors.clear();
+	other.current = other.limit = nullptr;
+	other.stats = ArenaStats();
+}
+
+// Освободить арену: вызвать отложенные деструкторы
+// в обратном порядке и вернуть блоки куче
+void Arena::Release()
+{
+	Destroy();
+
+	for (auto& block : blocks)
+	{
+		delete[] block.data;
+	}
+	blocks.clear();
+	current = limit = nullptr;
+}
+
+void Arena::Reset()
+{
+	Destroy();
+
+	if (blocks.empty()) return;
+	for (size_t i = 1; i < blocks.size(); i++)
+	{
+		delete[] blocks[i].data;
+	}
+	blocks.resize(1);
+	current = blocks[0].data;
+	limit = blocks[0].data + blocks[0].size;
+}
+
+// Деструкторы вызываются в обратном порядке создания объектов
+void Arena::Destroy()
+{
+	for (auto it = destructors.rbegin(); it != destructors.rend(); it++)
+	{
+		it->destroy(it->object);
+	}
+	destructors.clear();
+}
+
+const ArenaStats& Arena::GetStats() const
+{
+	return stats;
+}
+
+// Новый блок имеет размер blockSize,
+// или больше, если объект в него не помещается
+void Arena::AddBlock(size_t minimalSize)
+{
+	size_t size = minimalSize > blockSize ? minimalSize : blockSize;
+	Block block = { new char[size], size };
+	blocks.push_back(block);
+	current = block.data;
+	limit = block.data + size;
+	stats.blocks++;
+	stats.blockBytes += size;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+# include <cstddef>
+# include <new>
+# include <type_traits>
+# include <utility>
+# include <vector>
+
+// Арена - линейный распределитель памяти для узлов AST
+// Память выделяется из больших блоков простым сдвигом указателя,
+// а освобождается целиком вместе с ареной
+
+// Счётчики арены
+struct ArenaStats
+{
+	size_t objects = 0;     // Размещено объектов
+	size_t bytes = 0;       // Выделено байт под объекты
+	size_t blocks = 0;      // Запрошено блоков у кучи
+	size_t blockBytes = 0;  // Суммарный размер блоков
+	size_t destructors = 0; // Объектов, требующих вызова деструктора
+};
+
+class Arena
+{
+	// Блок памяти, из которого размещаются объекты
+	struct Block
+	{
+		char* data;
+		size_t size;
+	};
+
+	// Объект, деструктор которого нужно вызвать при освобождении арены
+	struct Destructor
+	{
+		void(*destroy)(void*);
+		void* object;
+	};
+
+	std::vector<Block> blocks;           // Полученные у кучи блоки
+	std::vector<Destructor> destructors; // Отложенные деструкторы
+	char* current = nullptr;             // Свободная часть текущего блока
+	char* limit = nullptr;               // Конец текущего блока
+	size_t blockSize;                    // Размер очередного блока
+	ArenaStats stats;
+public:
+	explicit Arena(size_t blockSize = 64 * 1024) : blockSize(blockSize) {}
+	~Arena();
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	// Выделить size байт с выравниванием alignment
+	void* Allocate(size_t size, size_t alignment);
+
+	// Создать в арене объект типа T
+	// Деструктор запоминается только для типов, которым он нужен
+	template<class T, class... Args> T* Create(Args&&... args);
+
+	// Создать в арене массив из count указателей
+	template<class T> T** CreateArray(size_t count);
+
+	// Забрать все объекты и блоки арены other, которая остаётся пустой
+	// Объекты other живут, пока живёт эта арена. Так собираются в одну
+	// узлы, размещённые на разных потоках в отдельных аренах
+	void Merge(Arena& other);
+
+	// Освободить все объекты и блоки арены
+	void Release();
+
+	// Освободить все объекты, но оставить первый блок для следующих,
+	// чтобы арена, переиспользуемая для многих небольших программ,
+	// не обращалась к куче при разборе каждой
+	void Reset();
+
+	const ArenaStats& GetStats() const;
+
+protected:
+	void AddBlock(size_t minimalSize); // Получить у кучи новый блок
+	void Destroy(); // Вызвать отложенные деструкторы
+};
+
+template<class T, class... Args> inline T* Arena::Create(Args&&... args)
+{
+	void* memory = Allocate(sizeof(T), alignof(T));
+	T* object = new (memory) T(std::forward<Args>(args)...);
+	if (!std::is_trivially_destructible<T>::value)
+	{
+		destructors.push_back({ [](void* p) { static_cast<T*>(p)->~T(); }, object });
+		stats.destructors++;
+	}
+	return object;
+}
+
+template<class T> inline T** Arena::CreateArray(size_t count)
+{
+	return static_cast<T**>(Allocate(sizeof(T*) * count, alignof(T*)));
+}
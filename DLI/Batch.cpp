@@ -0,0 +1,189 @@
+#include "Batch.h"
+
+# include "Parallel.h"
+# include <algorithm>
+# include <chrono>
+# include <filesystem>
+# include <memory>
+# include <fstream>
+# include <iterator>
+# include <sstream>
+
+// Каталоги раскрываются сразу, а файлы читаются по мере выполнения
+BatchReader::BatchReader(const std::vector<std::string>& inputs, std::istream& in) : in(in)
+{
+	for (auto& input : inputs)
+	{
+		std::error_code error;
+		if (input != "-" && std::filesystem::is_directory(input, error))
+		{
+			std::vector<std::string> files;
+			for (auto& entry : std::filesystem::directory_iterator(input, error))
+			{
+				if (entry.path().extension() == ".dl")
+					files.push_back(entry.path().string());
+			}
+			std::sort(files.begin(), files.end());
+			entries.insert(entries.end(), files.begin(), files.end());
+		}
+		else
+		{
+			entries.push_back(input);
+		}
+	}
+}
+
+bool BatchReader::Next(BatchProgram& program)
+{
+	while (next < entries.size())
+	{
+		auto& entry = entries[next];
+		if (entry == "-")
+		{
+			if (ReadFromStream(program)) return true;
+			next++;
+			continue;
+		}
+
+		next++;
+		program.name = entry;
+		program.source.clear();
+		program.error.clear();
+		std::ifstream file(entry, std::ios::binary);
+		if (!file.is_open())
+		{
+			program.error = "File doesn't exist";
+			return true;
+		}
+		program.source.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		return true;
+	}
+	return false;
+}
+
+// После неверной строки длины границы программ в потоке неизвестны,
+// поэтому чтение потока прекращается
+bool BatchReader::ReadFromStream(BatchProgram& program)
+{
+	std::string header;
+	while (std::getline(in, header) && header.find_first_not_of(" \t\r") == std::string::npos);
+	if (!in) return false;
+
+	program.name = "stdin#" + std::to_string(++streamPrograms);
+	program.source.clear();
+	program.error.clear();
+
+	// Поток size_t принимает и отрицательные числа, приводя их по модулю,
+	// поэтому знак минус проверяется отдельно
+	size_t length;
+	std::istringstream lengthStream(header);
+	if (header[header.find_first_not_of(" \t")] == '-' || !(lengthStream >> length))
+	{
+		program.error = "Invalid program length: " + header;
+		in.setstate(std::ios::failbit);
+		return true;
+	}
+
+	// Текст читается частями: длина в заголовке может быть сколь угодно
+	// большой, а память выделяется только под действительно прочитанное
+	while (program.source.size() < length)
+	{
+		char chunk[STREAM_CHUNK_SIZE];
+		size_t size = std::min(length - program.source.size(), sizeof(chunk));
+		in.read(chunk, size);
+		program.source.append(chunk, (size_t)in.gcount());
+		if ((size_t)in.gcount() != size)
+		{
+			program.error = "Unexpected end of stream";
+			program.source.clear();
+			break;
+		}
+	}
+	return true;
+}
+
+namespace
+{
+	// Вывести строку с результатом программы и учесть её в итоге
+	void Report(const std::string& name, const ProgramResult& result, BatchSummary& summary, std::ostream& out)
+	{
+		summary.programs++;
+		summary.time += result.time;
+		if (result.succeeded)
+		{
+			out << name << '\t' << result.text << '\n';
+		}
+		else
+		{
+			summary.failed++;
+			out << name << "\tERROR\t" << result.text << '\n';
+		}
+	}
+
+	// Программа, которую не удалось прочитать, завершается ошибкой чтения
+	ProgramResult ReadFailure(const BatchProgram& program)
+	{
+		ProgramResult result;
+		result.text = program.error;
+		return result;
+	}
+
+	double ElapsedSince(std::chrono::steady_clock::time_point begin)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+	}
+}
+
+BatchSummary RunBatch(BatchReader& reader, Interpreter& interpreter, std::ostream& out)
+{
+	auto begin = std::chrono::steady_clock::now();
+	BatchSummary summary;
+	BatchProgram program;
+	while (reader.Next(program))
+	{
+		auto result = program.error.empty() ? interpreter.Run(program.source) : ReadFailure(program);
+		Report(program.name, result, summary, out);
+	}
+	out.flush();
+	summary.wallTime = ElapsedSince(begin);
+	return summary;
+}
+
+// Интерпретатор создаётся в своём потоке при первой программе,
+// чтобы его куча с самого начала работала с пулом памяти этого потока
+BatchSummary RunBatch(BatchReader& reader, SymbolTable& symbols, const InterpreterOptions& options, ProgramCache* cache,
+	size_t threads, std::ostream& out)
+{
+	auto begin = std::chrono::steady_clock::now();
+	std::vector<BatchProgram> programs;
+	BatchProgram program;
+	while (reader.Next(program))
+	{
+		programs.push_back(std::move(program));
+	}
+
+	std::vector<std::unique_ptr<Interpreter>> interpreters(threads);
+	std::vector<ProgramResult> results(programs.size());
+	ParallelFor(programs.size(), threads, [&](size_t worker, size_t index)
+	{
+		auto& program = programs[index];
+		if (!program.error.empty())
+		{
+			results[index] = ReadFailure(program);
+			return;
+		}
+		if (!interpreters[worker])
+			interpreters[worker] = std::make_unique<Interpreter>(symbols, options, cache);
+		results[index] = interpreters[worker]->Run(program.source);
+	});
+	interpreters.clear();
+
+	BatchSummary summary;
+	for (size_t i = 0; i < programs.size(); i++)
+	{
+		Report(programs[i].name, results[i], summary, out);
+	}
+	out.flush();
+	summary.wallTime = ElapsedSince(begin);
+	return summary;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+# include "Interpreter.h"
+# include <cstddef>
+# include <istream>
+# include <ostream>
+# include <string>
+# include <vector>
+
+// Пакетное выполнение программ
+
+// Программа пакета
+struct BatchProgram
+{
+	std::string name;   // Имя файла или номер программы в потоке
+	std::string source; // Текст программы
+	std::string error;  // Ошибка чтения, если текст получить не удалось
+};
+
+// Источник программ пакета
+// Каждый вход - файл, каталог (все файлы .dl в нём по порядку имён)
+// или "-" - поток программ из stdin. В потоке каждой программе
+// предшествует строка с её длиной в байтах:
+//   <длина>\n<текст программы><длина>\n<текст программы>...
+// Программы читаются по одной, по мере выполнения
+class BatchReader
+{
+	// Размер части, которыми читается текст программы из потока
+	static const size_t STREAM_CHUNK_SIZE = 64 * 1024;
+
+	std::vector<std::string> entries; // Файлы и "-" в порядке выполнения
+	size_t next = 0;                  // Следующий вход
+	std::istream& in;                 // Поток для входа "-"
+	size_t streamPrograms = 0;        // Прочитано программ из потока
+public:
+	BatchReader(const std::vector<std::string>& inputs, std::istream& in);
+
+	// Прочитать следующую программу, false - программы закончились
+	bool Next(BatchProgram&);
+
+protected:
+	bool ReadFromStream(BatchProgram&); // Прочитать программу из потока
+};
+
+// Итог пакета
+struct BatchSummary
+{
+	size_t programs = 0; // Выполнено программ
+	size_t failed = 0;   // Из них завершились ошибкой
+	double time = 0;     // Суммарное время выполнения программ, мс
+	double wallTime = 0; // Время выполнения пакета, мс
+};
+
+// Выполнить все программы пакета на одном интерпретаторе
+// Для каждой программы в out выводится строка
+//   <имя>\t<результат>  или  <имя>\tERROR\t<описание ошибки>
+// Ошибка одной программы не прерывает пакет
+BatchSummary RunBatch(BatchReader&, Interpreter&, std::ostream& out);
+
+// Выполнить программы пакета на threads потоках
+// Все программы сначала читаются, затем распределяются между потоками
+// (см. ParallelFor). У каждого потока свой интерпретатор, общие у них
+// только таблица символов и кэш программ (cache может быть nullptr).
+// Результаты выводятся в порядке программ после выполнения всего пакета
+BatchSummary RunBatch(BatchReader&, SymbolTable&, const InterpreterOptions&, ProgramCache* cache,
+	size_t threads, std::ostream& out);
@@ -0,0 +1,139 @@
+#include "BufferLexer.h"
+
+# include <new>
+# include <utility>
+
+# include "Lexer.h"
+# include "Exceptions.h"
+
+BufferLexer::~BufferLexer()
+{
+	Destroy(token);
+	Destroy(lookahead);
+}
+
+Token* BufferLexer::Next()
+{
+	Destroy(token);
+	if (lookahead)
+		std::swap(token, lookahead);
+	else
+		token = Scan(nullptr);
+	return token;
+}
+
+Token* BufferLexer::Peek()
+{
+	if (!lookahead)
+		lookahead = Scan(token);
+	return lookahead;
+}
+
+void BufferLexer::Destroy(Token*& token)
+{
+	if (token) token->~Token();
+	token = nullptr;
+}
+
+void BufferLexer::SetScanner(const CharScanner& scanner)
+{
+	this->scanner = &scanner;
+}
+
+// Прочитать следующую лексему
+// В конце текста возвращается nullptr
+Token* BufferLexer::Scan(const Token* busy)
+{
+	auto& free = busy == (Token*)&storage[0] ? storage[1] : storage[0];
+	Lexeme lexeme;
+	return Scan(lexeme) ? CreateToken(lexeme, free) : nullptr;
+}
+
+// Позиция, как и в Lexer, указывает на последний прочитанный символ
+bool BufferLexer::Scan(Lexeme& lexeme)
+{
+	// Пропускаем пробелы, символы табуляции и перевода строки
+	// Серии символов в программах короткие, поэтому первый символ
+	// проверяется по таблице и CharScanner вызывается, только если серия есть
+	if (current < end && IsSpace((unsigned char)*current))
+	{
+		unsigned int lines = 0;
+		const char* lineStart = nullptr;
+		const char* next = scanner->skipSpaces(current, end, lines, lineStart);
+		if (lines > 0)
+		{
+			position.row += lines;
+			position.col = (unsigned int)(next - lineStart);
+		}
+		else
+		{
+			position.col += (unsigned int)(next - current);
+		}
+		current = next;
+	}
+	if (current == end) return false;
+
+	unsigned char ch = *current;
+	const char* begin = current++;
+	position.col++;
+	lexeme.position = position;
+
+	// Слово - буква, за которой следуют буквы и цифры
+	// Имя идентификатора копируется в таблицу символов только при первом появлении
+	if (IsLetter(ch))
+	{
+		if (current < end && IsAlnum((unsigned char)*current)) current = scanner->skipAlnum(current, end);
+		position.col += (unsigned int)(current - begin - 1);
+		auto word = std::string_view(begin, current - begin);
+		lexeme.keyword = FindKeyword(word);
+		if (lexeme.keyword != Keyword::None)
+		{
+			lexeme.type = TokenType::Keyword;
+		}
+		else
+		{
+			lexeme.type = TokenType::Identifier;
+			lexeme.id = symbols.Intern(word);
+		}
+		return true;
+	}
+
+	// Целое - цифра или минус, за которыми следуют цифры
+	if (IsDigit(ch) || ch == MINUS)
+	{
+		if (current < end && IsDigit((unsigned char)*current)) current = scanner->skipDigits(current, end);
+		position.col += (unsigned int)(current - begin - 1);
+		auto text = std::string_view(begin, current - begin);
+		lexeme.type = TokenType::Value;
+		lexeme.value = ParseInteger(text, lexeme.position);
+		return true;
+	}
+
+	if (ch == OPEN_BRACKET) lexeme.type = TokenType::OpenBracket;
+	else if (ch == CLOSE_BRACKET) lexeme.type = TokenType::CloseBracket;
+	else if (ch == ASSIGN_OPERATOR) lexeme.type = TokenType::AssignOperator;
+	else throw UnexpectedCharacterException(ch, lexeme.position);
+	return true;
+}
+
+Token* BufferLexer::CreateToken(const Lexeme& lexeme, TokenStorage& storage)
+{
+	void* memory = &storage;
+	switch (lexeme.type)
+	{
+		case TokenType::OpenBracket:
+			return new (memory) OpenBracketToken(lexeme.position);
+		case TokenType::CloseBracket:
+			return new (memory) CloseBracketToken(lexeme.position);
+		case TokenType::AssignOperator:
+			return new (memory) AssignOperatorToken(lexeme.position);
+		case TokenType::Keyword:
+			return new (memory) KeywordToken(lexeme.keyword, lexeme.position);
+		case TokenType::Identifier:
+			return new (memory) IdentifierToken(lexeme.id, lexeme.position);
+		case TokenType::Value:
+			return new (memory) ValueToken(lexeme.value, lexeme.position);
+		default:
+			return nullptr;
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+# include <string>
+# include <vector>
+# include "Position.h"
+# include "Token.h"
+# include "TokenStream.h"
+# include "SymbolTable.h"
+# include "CharScanner.h"
+
+// Лексема в компактном виде: тип, позиция и значение, без выделения памяти
+struct Lexeme
+{
+	PositionInText position;
+	Symbol id;                       // Идентификатор
+	int value = 0;                   // Значение целого
+	TokenType type = TokenType::Unknown;
+	Keyword keyword = Keyword::None; // Ключевое слово
+};
+
+// Лексический анализатор для текста, целиком находящегося в памяти
+// (например, в отображённом в память файле)
+// Читает символы сдвигом указателя, без потока ввода и возврата символов,
+// а идентификаторы заносит в таблицу символов прямо из исходного текста.
+// Пробелы, слова и числа пропускаются целиком с помощью CharScanner,
+// а позиция в тексте пересчитывается по длине пропущенного.
+// Выдаёт те же лексемы, что и Lexer
+class BufferLexer : public TokenStream
+{
+	SymbolTable &symbols;               // Таблица символов для идентификаторов
+	const char* current;                // Текущий символ
+	const char* end;                    // Конец текста
+	PositionInText position = { 1, 0 }; // Позиция в тексте
+	const CharScanner* scanner = &GetCharScanner(); // Поиск конца серий символов
+
+	// Выданная и просмотренная вперёд лексемы создаются по очереди
+	// в двух областях памяти, как и в Lexer
+	TokenStorage storage[2];
+	Token* token = nullptr;             // Последняя выданная лексема
+	Token* lookahead = nullptr;         // Просмотренная вперёд лексема
+public:
+	BufferLexer(SymbolTable& symbols, const char* begin, const char* end)
+		: symbols(symbols), current(begin), end(end) {}
+	// Текст может быть частью большего: тогда start - позиция
+	// последнего символа перед ним, и позиции лексем отсчитываются от неё
+	BufferLexer(SymbolTable& symbols, const char* begin, const char* end, const PositionInText& start)
+		: symbols(symbols), current(begin), end(end), position(start) {}
+	BufferLexer(const BufferLexer&) = delete;
+	BufferLexer& operator=(const BufferLexer&) = delete;
+	~BufferLexer();
+
+	// Прочитать следующую лексему
+	virtual Token* Next();
+
+	// Посмотреть следующую лексему, не читая её
+	virtual Token* Peek();
+
+	// Прочитать лексему из текста в компактном виде, false - конец текста
+	bool Scan(Lexeme&);
+
+	// Выбрать реализацию CharScanner, по умолчанию самая быстрая из доступных
+	void SetScanner(const CharScanner&);
+
+	// Создать лексему по её компактному виду в памяти storage,
+	// вызвать её деструктор должен вызывающий
+	static Token* CreateToken(const Lexeme&, TokenStorage& storage);
+protected:
+	// Прочитать лексему из текста в область памяти, не занятую лексемой busy
+	Token* Scan(const Token* busy);
+	void Destroy(Token*&);  // Уничтожить лексему
+};
@@ -0,0 +1,225 @@
+#include "Bytecode.h"
+#include "Exceptions.h"
+
+const std::vector<Instruction>& Program::GetCode() const
+{
+	return code;
+}
+
+const std::vector<CompiledFunction>& Program::GetFunctions() const
+{
+	return functions;
+}
+
+Expression* Program::GetSource(size_t address) const
+{
+	return sources[address];
+}
+
+size_t Program::Emit(const Instruction& instruction, Expression* source)
+{
+	code.push_back(instruction);
+	sources.push_back(source);
+	return code.size() - 1;
+}
+
+size_t Program::AddFunction(FunctionExpression* function)
+{
+	functions.push_back({ function, 0 });
+	return functions.size() - 1;
+}
+
+void Program::SetEntry(size_t function, size_t entry)
+{
+	functions[function].entry = entry;
+}
+
+void Program::Patch(size_t address, int target)
+{
+	code[address].a = target;
+}
+
+size_t Program::GetSize() const
+{
+	return code.size();
+}
+
+// Дизассемблировать программу, по инструкции в строке
+std::string Program::ToString() const
+{
+	static const char* names[] = {
+		"push_const", "push_empty", "load", "store", "pop",
+		"expect_int", "expect_closure", "add", "branch_if_le", "jump",
+		"enter_scope", "leave_scope", "make_closure", "call", "return", "halt"
+	};
+
+	std::string buff;
+	for (size_t address = 0; address < code.size(); address++)
+	{
+		auto& instruction = code[address];
+		buff += std::to_string(address) + ": " + names[(int)instruction.code];
+		switch (instruction.code)
+		{
+			case OpCode::Load:
+			case OpCode::Store:
+				buff += " " + std::to_string(instruction.a) + " " + std::to_string(instruction.b);
+				break;
+			case OpCode::PushConst:
+			case OpCode::BranchIfLe:
+			case OpCode::Jump:
+			case OpCode::MakeClosure:
+				buff += " " + std::to_string(instruction.a);
+				break;
+			default:
+				break;
+		}
+		buff += "\n";
+	}
+	return buff;
+}
+
+// Скомпилировать программу
+// Сначала компилируется основной код, завершающийся halt,
+// затем тела всех встреченных функций, каждое завершается return
+Program Compiler::Compile(Expression* expr)
+{
+	program = Program();
+	pendingFunctions.clear();
+
+	CompileExpression(expr);
+	program.Emit(Instruction(OpCode::Halt), expr);
+
+	while (!pendingFunctions.empty())
+	{
+		auto index = pendingFunctions.back();
+		pendingFunctions.pop_back();
+		auto function = program.GetFunctions()[index].function;
+		program.SetEntry(index, program.GetSize());
+		CompileExpression(function->GetBody());
+		program.Emit(Instruction(OpCode::Return), function);
+	}
+
+	return std::move(program);
+}
+
+void Compiler::CompileExpression(Expression* expr)
+{
+	switch (expr->GetKind())
+	{
+		case ExpressionKind::Val:
+			return CompileExpression(static_cast<ValExpression*>(expr));
+		case ExpressionKind::Var:
+			return CompileExpression(static_cast<VarExpression*>(expr));
+		case ExpressionKind::Add:
+			return CompileExpression(static_cast<AddExpression*>(expr));
+		case ExpressionKind::If:
+			return CompileExpression(static_cast<IfExpression*>(expr));
+		case ExpressionKind::Let:
+			return CompileExpression(static_cast<LetExpression*>(expr));
+		case ExpressionKind::Function:
+			return CompileExpression(static_cast<FunctionExpression*>(expr));
+		case ExpressionKind::Call:
+			return CompileExpression(static_cast<CallExpression*>(expr));
+		case ExpressionKind::Set:
+			return CompileExpression(static_cast<SetExpression*>(expr));
+		case ExpressionKind::Block:
+			return CompileExpression(static_cast<BlockExpression*>(expr));
+		default:
+			throw UnknownExpressionException(expr);
+	}
+}
+
+// Операнд, значение которого должно быть целым
+// Проверка нужна только для выражений, тип результата которых
+// неизвестен до выполнения; <val> и <add> всегда дают целое
+void Compiler::CompileInteger(Expression* expr)
+{
+	CompileExpression(expr);
+	auto kind = expr->GetKind();
+	if (kind != ExpressionKind::Val && kind != ExpressionKind::Add)
+		program.Emit(Instruction(OpCode::ExpectInt), expr);
+}
+
+void Compiler::CompileExpression(ValExpression* expr)
+{
+	program.Emit(Instruction(OpCode::PushConst, expr->GetValue()), expr);
+}
+
+void Compiler::CompileExpression(VarExpression* expr)
+{
+	auto& address = expr->GetAddress();
+	if (!address.resolved)
+		throw UndefinedVariableException(expr->GetId().GetName(), expr->GetPosition());
+	program.Emit(Instruction(OpCode::Load, address.depth, address.slot), expr);
+}
+
+void Compiler::CompileExpression(AddExpression* expr)
+{
+	CompileInteger(expr->GetLeftOperand());
+	CompileInteger(expr->GetRightOperand());
+	program.Emit(Instruction(OpCode::Add), expr);
+}
+
+// <left> <right> branch_if_le else <then> jump end else: <else> end:
+void Compiler::CompileExpression(IfExpression* expr)
+{
+	CompileInteger(expr->GetLeftOperand());
+	CompileInteger(expr->GetRightOperand());
+	auto branch = program.Emit(Instruction(OpCode::BranchIfLe), expr);
+	CompileExpression(expr->GetThenBranch());
+	auto jump = program.Emit(Instruction(OpCode::Jump), expr);
+	program.Patch(branch, (int)program.GetSize());
+	CompileExpression(expr->GetElseBranch());
+	program.Patch(jump, (int)program.GetSize());
+}
+
+// Значение переменной вычисляется уже в новой области видимости,
+// как и в Evaluator
+void Compiler::CompileExpression(LetExpression* expr)
+{
+	program.Emit(Instruction(OpCode::EnterScope), expr);
+	CompileExpression(expr->GetExpression());
+	program.Emit(Instruction(OpCode::Store, 0, 0), expr);
+	CompileExpression(expr->GetBody());
+	program.Emit(Instruction(OpCode::LeaveScope), expr);
+}
+
+// Тело функции компилируется позже, отдельным участком кода
+void Compiler::CompileExpression(FunctionExpression* expr)
+{
+	auto index = program.AddFunction(expr);
+	pendingFunctions.push_back(index);
+	program.Emit(Instruction(OpCode::MakeClosure, (int)index), expr);
+}
+
+void Compiler::CompileExpression(CallExpression* expr)
+{
+	auto callable = expr->GetCallable();
+	CompileExpression(callable);
+	if (callable->GetKind() != ExpressionKind::Function)
+		program.Emit(Instruction(OpCode::ExpectClosure), callable);
+	CompileExpression(expr->GetArgument());
+	program.Emit(Instruction(OpCode::Call), expr);
+}
+
+void Compiler::CompileExpression(SetExpression* expr)
+{
+	auto& address = expr->GetAddress();
+	if (!address.resolved)
+		throw UndefinedVariableException(expr->GetId().GetName(), expr->GetPosition());
+	CompileExpression(expr->GetExpression());
+	program.Emit(Instruction(OpCode::Store, address.depth, address.slot), expr);
+	program.Emit(Instruction(OpCode::PushEmpty), expr);
+}
+
+// Результаты всех выражений, кроме последнего, снимаются со стэка
+void Compiler::CompileExpression(BlockExpression* expr)
+{
+	bool first = true;
+	for (auto nested : expr->GetExpressions())
+	{
+		if (!first) program.Emit(Instruction(OpCode::Pop), expr);
+		CompileExpression(nested);
+		first = false;
+	}
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+# include "AST.h"
+# include <cstdint>
+# include <string>
+# include <vector>
+
+// Байт-код для виртуальной машины и компилятор AST в него
+// Каждая функция программы компилируется в линейный участок кода,
+// переменные адресуются лексическими адресами, вычисленными Resolver
+
+// Коды операций
+enum class OpCode : uint8_t {
+	PushConst,    // Положить на стэк целое a
+	PushEmpty,    // Положить на стэк пустое значение
+	Load,         // Положить на стэк значение ячейки по адресу (a, b)
+	Store,        // Снять значение со стэка и записать в ячейку по адресу (a, b)
+	Pop,          // Снять значение со стэка
+	ExpectInt,    // Проверить, что на вершине стэка целое
+	ExpectClosure,// Проверить, что на вершине стэка замыкание
+	Add,          // Снять два целых и положить их сумму
+	BranchIfLe,   // Снять два целых, перейти на a, если левое <= правого
+	Jump,         // Перейти на a
+	EnterScope,   // Создать область видимости с одной ячейкой
+	LeaveScope,   // Вернуться в родительскую область видимости
+	MakeClosure,  // Положить на стэк замыкание функции с номером a
+	Call,         // Снять аргумент и замыкание и вызвать функцию
+	Return,       // Вернуться из функции
+	Halt          // Завершить выполнение
+};
+
+// Инструкция: код операции и два операнда
+struct Instruction
+{
+	OpCode code;
+	int a = 0;
+	unsigned int b = 0;
+	Instruction(OpCode code, int a = 0, unsigned int b = 0) : code(code), a(a), b(b) {}
+};
+
+// Скомпилированная функция
+struct CompiledFunction
+{
+	FunctionExpression* function; // Определение функции в AST
+	size_t entry;                 // Адрес первой инструкции тела
+};
+
+// Скомпилированная программа
+class Program
+{
+	std::vector<Instruction> code;       // Инструкции
+	std::vector<Expression*> sources;    // Выражение, породившее каждую инструкцию
+	std::vector<CompiledFunction> functions; // Таблица функций
+public:
+	const std::vector<Instruction>& GetCode() const;
+	const std::vector<CompiledFunction>& GetFunctions() const;
+	Expression* GetSource(size_t address) const; // Выражение для инструкции по адресу
+
+	size_t Emit(const Instruction&, Expression* source); // Добавить инструкцию, вернуть её адрес
+	size_t AddFunction(FunctionExpression*); // Добавить функцию в таблицу, вернуть её номер
+	void SetEntry(size_t function, size_t entry);
+	void Patch(size_t address, int target); // Установить адрес перехода инструкции
+	size_t GetSize() const;
+
+	std::string ToString() const; // Дизассемблировать программу
+};
+
+// Компилятор AST в байт-код
+// AST должно быть обработано Resolver
+class Compiler
+{
+	Program program;
+	std::vector<size_t> pendingFunctions; // Функции, тела которых ещё не скомпилированы
+public:
+	Program Compile(Expression*);
+
+protected:
+	// Методы компиляции конкретных выражений
+	void CompileExpression(Expression*);
+	void CompileExpression(ValExpression*);
+	void CompileExpression(VarExpression*);
+	void CompileExpression(AddExpression*);
+	void CompileExpression(IfExpression*);
+	void CompileExpression(LetExpression*);
+	void CompileExpression(FunctionExpression*);
+	void CompileExpression(CallExpression*);
+	void CompileExpression(SetExpression*);
+	void CompileExpression(BlockExpression*);
+
+	// Скомпилировать операнд, значение которого должно быть целым
+	void CompileInteger(Expression*);
+};
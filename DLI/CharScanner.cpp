@@ -0,0 +1,254 @@
+#include "CharScanner.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+# define CHAR_SCANNER_X86
+# include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+# include <intrin.h>
+// Компилятор MSVC разрешает векторные инструкции в любой функции
+# define TARGET_SSE2
+# define TARGET_AVX2
+#else
+# define TARGET_SSE2 __attribute__((target("sse2")))
+# define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace
+{
+	// Скалярная реализация, она же проверяет остаток текста короче блока
+
+	const char* SkipSpacesScalar(const char* begin, const char* end, unsigned int& lines, const char*& lineStart)
+	{
+		for (; begin < end && IsSpace((unsigned char)*begin); begin++)
+		{
+			if (*begin == '\n')
+			{
+				lines++;
+				lineStart = begin + 1;
+			}
+		}
+		return begin;
+	}
+
+	const char* SkipAlnumScalar(const char* begin, const char* end)
+	{
+		while (begin < end && IsAlnum((unsigned char)*begin)) begin++;
+		return begin;
+	}
+
+	const char* SkipDigitsScalar(const char* begin, const char* end)
+	{
+		while (begin < end && IsDigit((unsigned char)*begin)) begin++;
+		return begin;
+	}
+
+	const CharScanner SCALAR_SCANNER = { "scalar", SkipSpacesScalar, SkipAlnumScalar, SkipDigitsScalar };
+
+#ifdef CHAR_SCANNER_X86
+
+	// Номер младшего и старшего установленного бита маски, маска не пуста
+	unsigned int LowestBit(unsigned int mask)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return index;
+#else
+		return __builtin_ctz(mask);
+#endif
+	}
+
+	unsigned int HighestBit(unsigned int mask)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanReverse(&index, mask);
+		return index;
+#else
+		return 31 - __builtin_clz(mask);
+#endif
+	}
+
+	// Учесть переводы строк блока block, отмеченные битами маски newlines
+	// Переводы строк в тексте редки, поэтому биты считаются по одному
+	void CountLines(const char* block, unsigned int newlines, unsigned int& lines, const char*& lineStart)
+	{
+		if (!newlines) return;
+		lineStart = block + HighestBit(newlines) + 1;
+		for (; newlines; newlines &= newlines - 1) lines++;
+	}
+
+	// SSE2: блоки по 16 символов
+	// Класс символа проверяется сравнением без знака: c - low <= high - low
+
+	TARGET_SSE2 __m128i InRange16(__m128i chars, char low, char high)
+	{
+		__m128i offset = _mm_sub_epi8(chars, _mm_set1_epi8(low));
+		return _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8((char)(high - low))), offset);
+	}
+
+	TARGET_SSE2 __m128i IsSpace16(__m128i chars)
+	{
+		return _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8(' ')), InRange16(chars, '\t', '\r'));
+	}
+
+	TARGET_SSE2 __m128i IsAlnum16(__m128i chars)
+	{
+		__m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+		return _mm_or_si128(InRange16(chars, '0', '9'), InRange16(lower, 'a', 'z'));
+	}
+
+	TARGET_SSE2 const char* SkipSpacesSse2(const char* begin, const char* end, unsigned int& lines, const char*& lineStart)
+	{
+		for (; end - begin >= 16; begin += 16)
+		{
+			__m128i chars = _mm_loadu_si128((const __m128i*)begin);
+			unsigned int other = ~_mm_movemask_epi8(IsSpace16(chars)) & 0xFFFF;
+			unsigned int newlines = _mm_movemask_epi8(_mm_cmpeq_epi8(chars, _mm_set1_epi8('\n')));
+			if (other)
+			{
+				unsigned int length = LowestBit(other);
+				CountLines(begin, newlines & ((1u << length) - 1), lines, lineStart);
+				return begin + length;
+			}
+			CountLines(begin, newlines, lines, lineStart);
+		}
+		return SkipSpacesScalar(begin, end, lines, lineStart);
+	}
+
+	TARGET_SSE2 const char* SkipAlnumSse2(const char* begin, const char* end)
+	{
+		for (; end - begin >= 16; begin += 16)
+		{
+			unsigned int other = ~_mm_movemask_epi8(IsAlnum16(_mm_loadu_si128((const __m128i*)begin))) & 0xFFFF;
+			if (other) return begin + LowestBit(other);
+		}
+		return SkipAlnumScalar(begin, end);
+	}
+
+	TARGET_SSE2 const char* SkipDigitsSse2(const char* begin, const char* end)
+	{
+		for (; end - begin >= 16; begin += 16)
+		{
+			unsigned int other = ~_mm_movemask_epi8(InRange16(_mm_loadu_si128((const __m128i*)begin), '0', '9')) & 0xFFFF;
+			if (other) return begin + LowestBit(other);
+		}
+		return SkipDigitsScalar(begin, end);
+	}
+
+	const CharScanner SSE2_SCANNER = { "sse2", SkipSpacesSse2, SkipAlnumSse2, SkipDigitsSse2 };
+
+	// AVX2: блоки по 32 символа
+
+	TARGET_AVX2 __m256i InRange32(__m256i chars, char low, char high)
+	{
+		__m256i offset = _mm256_sub_epi8(chars, _mm256_set1_epi8(low));
+		return _mm256_cmpeq_epi8(_mm256_min_epu8(offset, _mm256_set1_epi8((char)(high - low))), offset);
+	}
+
+	TARGET_AVX2 __m256i IsSpace32(__m256i chars)
+	{
+		return _mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8(' ')), InRange32(chars, '\t', '\r'));
+	}
+
+	TARGET_AVX2 __m256i IsAlnum32(__m256i chars)
+	{
+		__m256i lower = _mm256_or_si256(chars, _mm256_set1_epi8(0x20));
+		return _mm256_or_si256(InRange32(chars, '0', '9'), InRange32(lower, 'a', 'z'));
+	}
+
+	TARGET_AVX2 const char* SkipSpacesAvx2(const char* begin, const char* end, unsigned int& lines, const char*& lineStart)
+	{
+		for (; end - begin >= 32; begin += 32)
+		{
+			__m256i chars = _mm256_loadu_si256((const __m256i*)begin);
+			unsigned int other = ~(unsigned int)_mm256_movemask_epi8(IsSpace32(chars));
+			unsigned int newlines = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\n')));
+			if (other)
+			{
+				unsigned int length = LowestBit(other);
+				CountLines(begin, newlines & ((1u << length) - 1), lines, lineStart);
+				return begin + length;
+			}
+			CountLines(begin, newlines, lines, lineStart);
+		}
+		return SkipSpacesSse2(begin, end, lines, lineStart);
+	}
+
+	TARGET_AVX2 const char* SkipAlnumAvx2(const char* begin, const char* end)
+	{
+		for (; end - begin >= 32; begin += 32)
+		{
+			unsigned int other = ~(unsigned int)_mm256_movemask_epi8(IsAlnum32(_mm256_loadu_si256((const __m256i*)begin)));
+			if (other) return begin + LowestBit(other);
+		}
+		return SkipAlnumSse2(begin, end);
+	}
+
+	TARGET_AVX2 const char* SkipDigitsAvx2(const char* begin, const char* end)
+	{
+		for (; end - begin >= 32; begin += 32)
+		{
+			unsigned int other = ~(unsigned int)_mm256_movemask_epi8(InRange32(_mm256_loadu_si256((const __m256i*)begin), '0', '9'));
+			if (other) return begin + LowestBit(other);
+		}
+		return SkipDigitsSse2(begin, end);
+	}
+
+	const CharScanner AVX2_SCANNER = { "avx2", SkipSpacesAvx2, SkipAlnumAvx2, SkipDigitsAvx2 };
+
+	// Поддержка наборов инструкций процессором и операционной системой
+#ifdef _MSC_VER
+	bool HasSse2()
+	{
+		int info[4];
+		__cpuid(info, 1);
+		return (info[3] & (1 << 26)) != 0;
+	}
+
+	bool HasAvx2()
+	{
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) return false;
+		__cpuid(info, 1);
+		// Регистры AVX должны сохраняться операционной системой (OSXSAVE и XCR0)
+		bool osSupport = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+		__cpuidex(info, 7, 0);
+		return osSupport && (info[1] & (1 << 5)) != 0;
+	}
+#else
+	bool HasSse2()
+	{
+		return __builtin_cpu_supports("sse2");
+	}
+
+	bool HasAvx2()
+	{
+		return __builtin_cpu_supports("avx2");
+	}
+#endif
+
+#endif // CHAR_SCANNER_X86
+}
+
+std::vector<const CharScanner*> GetCharScanners()
+{
+	std::vector<const CharScanner*> scanners = { &SCALAR_SCANNER };
+#ifdef CHAR_SCANNER_X86
+	if (HasSse2())
+	{
+		scanners.push_back(&SSE2_SCANNER);
+		if (HasAvx2()) scanners.push_back(&AVX2_SCANNER);
+	}
+#endif
+	return scanners;
+}
+
+const CharScanner& GetCharScanner()
+{
+	static const CharScanner& scanner = *GetCharScanners().back();
+	return scanner;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+# include <cstddef>
+# include <vector>
+
+// Классификация символов текста программы
+// Классы задаются таблицей, построенной во время компиляции, и совпадают
+// с isspace, isalpha и isdigit в локали "C", но не зависят от текущей локали
+// и не требуют вызова функции на каждый символ
+
+const unsigned char CHAR_SPACE = 1;   // Пробел, табуляция, перевод строки и т. п.
+const unsigned char CHAR_LETTER = 2;  // Латинская буква
+const unsigned char CHAR_DIGIT = 4;   // Десятичная цифра
+
+constexpr unsigned char ClassifyChar(unsigned char ch)
+{
+	if (ch == ' ' || (ch >= '\t' && ch <= '\r')) return CHAR_SPACE;
+	if ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z')) return CHAR_LETTER;
+	if (ch >= '0' && ch <= '9') return CHAR_DIGIT;
+	return 0;
+}
+
+// Таблица классов всех 256 значений байта
+struct CharClassTable
+{
+	unsigned char classes[256];
+	constexpr CharClassTable() : classes()
+	{
+		for (unsigned ch = 0; ch < 256; ch++)
+		{
+			classes[ch] = ClassifyChar((unsigned char)ch);
+		}
+	}
+};
+
+constexpr CharClassTable CHAR_CLASSES;
+
+inline bool IsSpace(unsigned char ch) { return CHAR_CLASSES.classes[ch] & CHAR_SPACE; }
+inline bool IsLetter(unsigned char ch) { return CHAR_CLASSES.classes[ch] & CHAR_LETTER; }
+inline bool IsDigit(unsigned char ch) { return CHAR_CLASSES.classes[ch] & CHAR_DIGIT; }
+inline bool IsAlnum(unsigned char ch) { return CHAR_CLASSES.classes[ch] & (CHAR_LETTER | CHAR_DIGIT); }
+
+// Поиск конца серии символов одного класса в тексте, находящемся в памяти
+// Векторные реализации проверяют по 16 (SSE2) или 32 (AVX2) символа за раз,
+// остаток текста короче блока проверяется по таблице классов
+struct CharScanner
+{
+	const char* name;
+
+	// Первый непробельный символ в [begin, end) или end
+	// Число пропущенных переводов строки прибавляется к lines,
+	// а если они были, lineStart указывает на символ после последнего из них
+	const char* (*skipSpaces)(const char* begin, const char* end, unsigned int& lines, const char*& lineStart);
+
+	// Первый символ в [begin, end), не являющийся буквой или цифрой, или end
+	const char* (*skipAlnum)(const char* begin, const char* end);
+
+	// Первый символ в [begin, end), не являющийся цифрой, или end
+	const char* (*skipDigits)(const char* begin, const char* end);
+};
+
+// Самая быстрая реализация, поддерживаемая процессором
+// Выбирается один раз, при первом вызове
+const CharScanner& GetCharScanner();
+
+// Все реализации, поддерживаемые процессором, от скалярной к самой быстрой
+std::vector<const CharScanner*> GetCharScanners();
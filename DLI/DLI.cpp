@@ -2,59 +2,373 @@
 
 # include "Parser.h"
 # include "Lexer.h"
+# include "BufferLexer.h"
+# include "ParallelLexer.h"
+# include "ParallelParser.h"
+# include "MappedFile.h"
+# include "Resolver.h"
+# include "Optimizer.h"
+# include "PurityAnalyzer.h"
 # include "Evaluator.h"
+# include "Bytecode.h"
+# include "VirtualMachine.h"
+# include "ThunkExecutor.h"
 # include "Exceptions.h"
+# include "SymbolTable.h"
+# include "RunStats.h"
+# include "Profiler.h"
+# include "Interpreter.h"
+# include "Batch.h"
+# include "Parallel.h"
+# include "Serialization.h"
 
 # include <sstream>
 # include <vector>
 # include <fstream>
+# include <memory>
+# include <stdexcept>
+# include <chrono>
+# include <iterator>
 
-/* 
-* TODO: 
-* Новый алгоритм управления областями видимости
-*/
+// Вывести в stderr счётчики кучи исполнителя
+void PrintHeapStats(const HeapStats& stats)
+{
+	std::cerr << "Heap: " << stats.collections << " collections, "
+		<< stats.scopesFreed << " scopes (" << stats.bytesFreed << " bytes) freed, "
+		<< "pause " << stats.pauseTime << " ms (max " << stats.maxPause << " ms), "
+		<< stats.liveScopes << " live scopes (" << stats.liveBytes << " bytes), "
+		<< "peak " << stats.peakBytes << " bytes" << std::endl;
+}
+
+// Время, прошедшее с момента begin, мс
+double ElapsedSince(std::chrono::steady_clock::time_point begin)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
 
-int main()
+// Запуск: DLI [--vm | --thunks] [--dump-bytecode] [--arena-stats] [--mmap] [--lexer-threads <потоков>]
+//             [--parser-threads <потоков>] [--eval-threads <потоков>]
+//             [--no-optimize] [--dump-optimized] [--stats] [--stats-json]
+//             [--profile <файл>] [--profile-period <шагов>]
+//             [--gc-stats] [--heap-size <байт>] [--gc-threshold <число>]
+//             [--save-ast <файл>] [файл программы]
+//         DLI --batch [--jobs <потоков>] [--cache-size <байт>] [--vm | --thunks] [--no-optimize]
+//             [--heap-size <байт>] [--gc-threshold <число>] <файл | каталог | ->...
+// По умолчанию программа читается из input.txt и выполняется Evaluator,
+// с ключом --vm она компилируется в байт-код и выполняется VirtualMachine,
+// с ключом --thunks - в дерево узлов и выполняется ThunkExecutor,
+// с ключом --mmap файл отображается в память и читается BufferLexer.
+// --lexer-threads задаёт число потоков лексического анализа (0 - по числу ядер):
+// текст программы целиком загружается в память и читается ParallelLexer.
+// --parser-threads задаёт число потоков синтаксического анализа (0 - по числу ядер):
+// вложенные выражения внешнего блока программы разбираются ParallelParser параллельно.
+// --eval-threads задаёт число потоков Evaluator (0 - по числу ядер): чистые операнды
+// <add> и <if>, содержащие вызовы, вычисляются параллельно на пуле потоков.
+// Перед выполнением AST оптимизируется, если не указан ключ --no-optimize.
+// --save-ast сохраняет подготовленное AST в двоичном формате, такой файл
+// можно передать вместо текста программы, он загружается без разбора.
+// --heap-size и --gc-threshold задают, при каком объёме областей видимости
+// и после скольких созданных областей запускается сборка циклов.
+// --stats и --stats-json выводят в stderr время этапов и счётчики выполнения,
+// в том числе если программа завершилась ошибкой.
+// --profile включает профилировщик исполнителя: отчёт выводится в stderr,
+// а свёрнутые стэки для flamegraph записываются в указанный файл.
+// С ключом --batch выполняются все перечисленные программы на одном
+// интерпретаторе, для каждой выводится строка с результатом или ошибкой.
+// --jobs задаёт число потоков пакета, 0 - по числу ядер,
+// --cache-size включает кэш подготовленных программ указанного объёма
+int main(int argc, char** argv)
 {
-	// Список ключевых слов языка
-	std::vector<std::string> keywords = {
-		"val", "var", "add", "if", "then", 
-		"else", "let", "in", "function", 
-		"call", "set", "block"
-	};
+	std::string fileName = "input.txt";
+	std::vector<std::string> inputs;
+	bool batch = false;
+	size_t jobs = 1;
+	size_t cacheSize = 0;
+	bool useVirtualMachine = false;
+	bool useThunks = false;
+	bool dumpBytecode = false;
+	bool arenaStats = false;
+	bool useMappedFile = false;
+	size_t lexerThreads = 1;
+	size_t parserThreads = 1;
+	size_t evalThreads = 1;
+	bool optimize = true;
+	bool dumpOptimized = false;
+	bool heapStats = false;
+	bool runStats = false;
+	bool runStatsJson = false;
+	std::string profileFileName;
+	size_t profilePeriod = 1000;
+	std::string saveAstFileName;
+	HeapOptions heapOptions;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--vm")
+		{
+			useVirtualMachine = true;
+			useThunks = false;
+		}
+		else if (arg == "--thunks")
+		{
+			useThunks = true;
+			useVirtualMachine = false;
+		}
+		else if (arg == "--dump-bytecode")
+			dumpBytecode = true;
+		else if (arg == "--arena-stats")
+			arenaStats = true;
+		else if (arg == "--mmap")
+			useMappedFile = true;
+		else if (arg == "--lexer-threads" && hasValue)
+			lexerThreads = std::stoul(argv[++i]);
+		else if (arg == "--parser-threads" && hasValue)
+			parserThreads = std::stoul(argv[++i]);
+		else if (arg == "--eval-threads" && hasValue)
+			evalThreads = std::stoul(argv[++i]);
+		else if (arg == "--no-optimize")
+			optimize = false;
+		else if (arg == "--dump-optimized")
+			dumpOptimized = true;
+		else if (arg == "--gc-stats")
+			heapStats = true;
+		else if (arg == "--stats")
+			runStats = true;
+		else if (arg == "--stats-json")
+			runStatsJson = true;
+		else if (arg == "--profile" && hasValue)
+			profileFileName = argv[++i];
+		else if (arg == "--profile-period" && hasValue)
+			profilePeriod = std::stoul(argv[++i]);
+		else if (arg == "--save-ast" && hasValue)
+			saveAstFileName = argv[++i];
+		else if (arg == "--heap-size" && hasValue)
+			heapOptions.heapSize = std::stoul(argv[++i]);
+		else if (arg == "--gc-threshold" && hasValue)
+			heapOptions.collectionThreshold = std::stoul(argv[++i]);
+		else if (arg == "--batch")
+			batch = true;
+		else if (arg == "--jobs" && hasValue)
+			jobs = std::stoul(argv[++i]);
+		else if (arg == "--cache-size" && hasValue)
+			cacheSize = std::stoul(argv[++i]);
+		else
+			inputs.push_back(arg);
+	}
+
+	if (batch)
+	{
+		InterpreterOptions options;
+		options.optimize = optimize;
+		options.useVirtualMachine = useVirtualMachine;
+		options.useThunks = useThunks;
+		options.heap = heapOptions;
+		if (jobs == 0) jobs = GetDefaultThreadCount();
+
+		// Таблица символов объявлена раньше кэша, так как должна его пережить
+		SymbolTable symbols;
+		std::unique_ptr<ProgramCache> cache;
+		if (cacheSize > 0) cache = std::make_unique<ProgramCache>(cacheSize);
+
+		// В одном потоке программы выполняются по мере чтения
+		BatchReader reader(inputs, std::cin);
+		BatchSummary summary;
+		if (jobs == 1)
+		{
+			Interpreter interpreter(symbols, options, cache.get());
+			summary = RunBatch(reader, interpreter, std::cout);
+		}
+		else
+		{
+			summary = RunBatch(reader, symbols, options, cache.get(), jobs, std::cout);
+		}
+		std::cerr << "Batch: " << summary.programs << " programs, "
+			<< summary.failed << " failed, " << summary.time << " ms in programs, "
+			<< summary.wallTime << " ms total, " << jobs << " threads" << std::endl;
+		if (cache)
+		{
+			auto cacheStats = cache->GetStats();
+			std::cerr << "Cache: " << cacheStats.hits << " hits, " << cacheStats.misses << " misses, "
+				<< cacheStats.evictions << " evictions, " << cacheStats.entries << " programs ("
+				<< cacheStats.bytes << " bytes)" << std::endl;
+		}
+		return summary.failed == 0 ? 0 : 1;
+	}
+
+	if (!inputs.empty()) fileName = inputs.back();
+	if (lexerThreads == 0) lexerThreads = GetDefaultThreadCount();
+	if (parserThreads == 0) parserThreads = GetDefaultThreadCount();
+	if (evalThreads == 0) evalThreads = GetDefaultThreadCount();
 
-	std::ifstream in("input.txt", std::ifstream::in);
+	// Текст программы читается либо из потока,
+	// либо напрямую из отображённого в память файла
+	std::ifstream in;
+	std::unique_ptr<MappedFile> mappedFile;
+	// Сохранённое AST и текст для параллельного чтения и разбора загружаются в память целиком
+	std::string contents;
+	const char* data = nullptr;   // Программа в памяти
+	size_t size = 0;
+	bool isSerialized = false;
 
-	if (!in.is_open())
+	if (useMappedFile)
+	{
+		mappedFile = std::make_unique<MappedFile>(fileName);
+		data = mappedFile->GetData();
+		size = mappedFile->GetSize();
+		isSerialized = IsSerializedProgram(data, size);
+	}
+	else
 	{
-		throw std::exception("File doesn't exist");
+		in.open(fileName, std::ifstream::in | std::ifstream::binary);
+		if (!in.is_open())
+		{
+			throw std::runtime_error("File doesn't exist");
+		}
+
+		// Формат определяется по первым байтам файла
+		char header[4];
+		in.read(header, sizeof(header));
+		isSerialized = IsSerializedProgram(header, in.gcount());
+		in.clear();
+		in.seekg(0);
+		if (isSerialized || lexerThreads > 1 || parserThreads > 1)
+		{
+			contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+			data = contents.data();
+			size = contents.size();
+		}
 	}
 
+	// Имена переменных хранятся в таблице символов,
+	// узлы AST программы размещаются в арене
+	// и освобождаются вместе с ней
+	SymbolTable symbols;
+	Arena arena;
+
+	// Исполнитель живёт дольше блока try, чтобы его счётчики
+	// можно было вывести и после ошибки выполнения
+	std::unique_ptr<VirtualMachine> machine;
+	std::unique_ptr<ThunkExecutor> thunkExecutor;
+	std::unique_ptr<TaskPool> taskPool;     // Пул потоков исполнителя, живёт дольше него
+	std::unique_ptr<Evaluator> evaluator;
+	std::unique_ptr<Profiler> profiler;
+	RunStats stats;
+
 	try {
 
-		// Лексический анализ
-		Lexer lex(keywords, in);
-		auto tokens = lex.Tokenize();
+		// Синтаксический анализ или загрузка сохранённого AST
+		auto begin = std::chrono::steady_clock::now();
+		Expression* expr;
+		if (isSerialized)
+		{
+			expr = DeserializeProgram(data, size, arena, symbols);
+		}
+		else if (parserThreads > 1)
+		{
+			// Вложенные выражения внешнего блока разбираются на нескольких потоках,
+			// каждое своим лексическим анализатором
+			ParallelParser parser(symbols, arena, parserThreads);
+			expr = parser.Parse(data, data + size);
+			stats.parser = parser.GetStats();
+		}
+		else
+		{
+			// Лексический анализатор выдаёт лексемы по мере их чтения
+			// синтаксическим анализатором, ParallelLexer читает их заранее
+			std::unique_ptr<TokenStream> lex;
+			if (lexerThreads > 1)
+			{
+				lex = std::make_unique<ParallelLexer>(symbols, data, data + size, lexerThreads);
+			}
+			else if (data)
+			{
+				lex = std::make_unique<BufferLexer>(symbols, data, data + size);
+			}
+			else
+			{
+				lex = std::make_unique<Lexer>(symbols, in);
+			}
+
+			Parser parser(*lex, arena);
+			expr = parser.Parse();
+			stats.parser = parser.GetStats();
+		}
+		stats.times.parse = ElapsedSince(begin);
 
-		// Синтаксический анализ
-		Parser parser(tokens);
-		auto expr = parser.Parse();
+		// Разрешение имён переменных
+		begin = std::chrono::steady_clock::now();
+		Resolver resolver;
+		resolver.Resolve(expr);
+		stats.times.resolve = ElapsedSince(begin);
 
-		// Выполнение кода
-		Evaluator vm;
-		auto expr2 = vm.Eval(expr);
+		// Оптимизация AST и повторное разрешение имён в изменённом дереве
+		if (optimize)
+		{
+			begin = std::chrono::steady_clock::now();
+			Optimizer optimizer(arena);
+			expr = optimizer.Optimize(expr);
+			resolver.Resolve(expr);
+			stats.times.optimize = ElapsedSince(begin);
+			if (dumpOptimized) std::cerr << expr->ToString() << std::endl;
+		}
 
-		std::cout << expr2->ToString() << std::endl;
+		if (!saveAstFileName.empty())
+		{
+			std::ofstream out(saveAstFileName, std::ofstream::out | std::ofstream::binary);
+			out << SerializeProgram(expr);
+		}
 
-		// Подчищаем за собой
+		// Выполнение кода
+		Value result;
+		if (useVirtualMachine)
+		{
+			begin = std::chrono::steady_clock::now();
+			Compiler compiler;
+			auto program = compiler.Compile(expr);
+			stats.times.compile = ElapsedSince(begin);
+			if (dumpBytecode) std::cerr << program.ToString();
 
-		delete expr;
-		delete expr2;
+			begin = std::chrono::steady_clock::now();
+			machine = std::make_unique<VirtualMachine>(heapOptions);
+			result = machine->Run(program);
+			stats.times.eval = ElapsedSince(begin);
+		}
+		else if (useThunks)
+		{
+			begin = std::chrono::steady_clock::now();
+			ThunkCompiler compiler;
+			auto program = compiler.Compile(expr);
+			stats.times.compile = ElapsedSince(begin);
 
-		for (auto token : tokens)
+			begin = std::chrono::steady_clock::now();
+			thunkExecutor = std::make_unique<ThunkExecutor>(heapOptions);
+			result = thunkExecutor->Run(*program);
+			stats.times.eval = ElapsedSince(begin);
+		}
+		else
 		{
-			delete token;
+			begin = std::chrono::steady_clock::now();
+			evaluator = std::make_unique<Evaluator>(heapOptions);
+			if (!profileFileName.empty())
+			{
+				profiler = std::make_unique<Profiler>(profilePeriod);
+				profiler->Prepare(expr);
+				evaluator->SetProfiler(profiler.get());
+			}
+			if (evalThreads > 1)
+			{
+				PurityAnalyzer analyzer;
+				analyzer.Analyze(expr);
+				taskPool = std::make_unique<TaskPool>(evalThreads);
+				evaluator->SetTaskPool(taskPool.get());
+			}
+			result = evaluator->Eval(expr);
+			stats.times.eval = ElapsedSince(begin);
 		}
+
+		std::cout << result.ToString() << std::endl;
 	}
 	catch (InterpreterException& e)
 	{
@@ -62,5 +376,45 @@ int main()
 		std::cerr << e.What() << std::endl;
 	}
 
+	// Счётчики выполнения берутся у того исполнителя, который был создан
+	if (machine)
+	{
+		stats.execution = machine->GetStats();
+		stats.heap = machine->GetHeapStats();
+	}
+	else if (thunkExecutor)
+	{
+		stats.execution = thunkExecutor->GetStats();
+		stats.heap = thunkExecutor->GetHeapStats();
+	}
+	else if (evaluator)
+	{
+		stats.execution = evaluator->GetStats();
+		stats.heap = evaluator->GetHeapStats();
+	}
+	if (heapStats && (machine || thunkExecutor || evaluator)) PrintHeapStats(stats.heap);
+	if (runStats) PrintStats(std::cerr, stats);
+	if (runStatsJson) PrintStatsJson(std::cerr, stats);
+
+	if (profiler)
+	{
+		profiler->Report(std::cerr);
+		std::ofstream profile(profileFileName);
+		profiler->WriteFoldedStacks(profile);
+	}
+	else if (!profileFileName.empty() && (useVirtualMachine || useThunks))
+	{
+		std::cerr << "Profiler is available only without --vm and --thunks" << std::endl;
+	}
+
+	if (arenaStats)
+	{
+		auto& stats = arena.GetStats();
+		std::cerr << "Arena: " << stats.objects << " objects, "
+			<< stats.bytes << " bytes, "
+			<< stats.blocks << " blocks (" << stats.blockBytes << " bytes), "
+			<< stats.destructors << " destructors" << std::endl;
+	}
+
 	return 0;
 }
\ No newline at end of file
@@ -1,344 +1,384 @@
 #include "Evaluator.h"
 #include "Exceptions.h"
-#include <stdexcept>
 
-// При удалении Scope
-// Удаляются все хранящиеся в нём Expression
-Scope::~Scope()
-{
-	for (auto p : values)
-	{
-		auto expr = p.second;
-		if (expr != nullptr)
-		{
-			delete expr;
-		}
-	}
-}
+# include <algorithm>
 
-// Получить значение из Scope
-// Если его нет, будет выбрашено исключение
-const Expression* Scope::GetValue(const std::string& key)
+namespace
 {
-	try {
-		return values.at(key);
-	}
-	catch (std::out_of_range ex) {
-		throw UndefinedVariableException(key);
-	}
+	// Выбрасывается в отменённом задании: ошибка левого операнда
+	// делает значение правого ненужным. Наружу не выходит
+	struct EvaluationCancelled {};
 }
 
-// Добавить значение в Scope
-void Scope::AddValue(const std::string& key, Expression* value)
-{
-	values.insert(std::pair<const std::string, Expression*>(key, value));
-}
-
-// Установить значение в Scope
-// Если его нет будет выбрашено исключение
-void Scope::SetValue(const std::string& key, Expression* value)
+// Создать новый исполнитель
+Evaluator::Evaluator(const HeapOptions& options) : heapOptions(options), heap(options)
 {
-	try {
-		static_cast<void>(values.at(key));
-		values[key] = value;
-	}
-	catch (std::out_of_range ex) {
-		throw UndefinedVariableException(key);
-	}
+	PushScope(heap.CreateScope(nullptr, 0));
 }
 
-// Попытка получить значение из Scope, не возбуждая исключения
-// Значение будет возращено с помощью указателя value
-// Возвращаемое значение функции показывает, успешна ли была операция
-bool Scope::TryGet(const std::string& key, Expression** value)
+const HeapStats& Evaluator::GetHeapStats() const
 {
-	if (values.count(key) != 0) {
-		*value = values.at(key);
-		return true;
-	}
-	*value = nullptr;
-	return false;
+	return heap.GetStats();
 }
 
-// Попытка установить значение в Scope, не возбуждая исключения
-// Возвращаемое значение функции показывает, успешна ли была операция
-bool Scope::TrySet(const std::string& key, Expression* value)
+const ExecutionStats& Evaluator::GetStats() const
 {
-	if (values.count(key) != 0) {
-		values[key] = value;
-		return true;
-	}
-	return false;
+	return stats;
 }
 
-// Получить родительскую область видимости
-Scope* Scope::GetParent()
+void Evaluator::SetProfiler(Profiler* profiler)
 {
-	return parentScope;
+	this->profiler = profiler;
 }
 
-// Создать новый исполнитель с заданной глобальной областью видимости
-Evaluator::Evaluator(Scope* global)
+// Вложенность параллельных вычислений ограничена так, чтобы двоичное дерево
+// заданий, как у рекурсивной функции с двумя вызовами в <add>, содержало
+// около TASKS_PER_THREAD заданий на поток
+void Evaluator::SetTaskPool(TaskPool* pool)
 {
-	scopeStack.push(new Scope(global));
-}
-
-// Создать новый исполнитель
-Evaluator::Evaluator()
-{
-	scopeStack.push(new Scope());
+	this->pool = pool;
+	maxForkDepth = 0;
+	if (!pool) return;
+	for (size_t tasks = 1; tasks < pool->GetThreadCount() * TASKS_PER_THREAD; tasks *= 2)
+	{
+		maxForkDepth++;
+	}
 }
 
-Evaluator::~Evaluator()
+void Evaluator::Reset()
 {
-	delete PopScope();
+	LeaveScopes(1);
+	if (profiler) profiler->Return(0);
 }
 
-// Получить значение выражения.
-// Если выражение не является <val>,
+// Выполнить выражение и получить его целое значение.
+// Если результат не является целым,
 // то будет вызвано исключение
 int Evaluator::GetValue(Expression * expression)
 {
-	auto valExpression = dynamic_cast<ValExpression*>(expression);
-	if (valExpression) return valExpression->GetValue();
-	throw ExpressionIsNotValueException(valExpression);
+	// Литералы и переменные, частые операнды <add> и <if>,
+	// читаются напрямую, без цикла Eval и копирования значения
+	switch (expression->GetKind())
+	{
+		case ExpressionKind::Val:
+			return static_cast<ValExpression*>(expression)->GetValue();
+		case ExpressionKind::Var:
+		{
+			auto& value = ReadVariable(static_cast<VarExpression*>(expression));
+			if (value.GetType() == ValueType::Integer) return value.GetInteger();
+			throw ExpressionIsNotValueException(expression);
+		}
+		default:
+		{
+			auto value = Eval(expression);
+			if (value.GetType() == ValueType::Integer) return value.GetInteger();
+			throw ExpressionIsNotValueException(expression);
+		}
+	}
 }
 
-// Получить значение из текущей или вышележащих областей видимости
-Expression* Evaluator::FromEnv(std::string& key)
+// Выполнить выражение
+// Выражения в хвостовой позиции выполняются на следующей итерации цикла,
+// а области видимости, созданные на этих итерациях, освобождаются при выходе
+Value Evaluator::Eval(Expression* expr)
 {
-	Expression* expr = nullptr;
-	Scope* scope;
+	// Области видимости выше этой глубины принадлежат текущему вызову Eval
+	size_t depth = scopeStack.size();
+	Value result;
 
-	// Поднимаясь по цепочке областей видимости
-	// От дочерней к родительской
-	for (scope = CurrentScope(); scope != nullptr; scope = scope->GetParent())
+	// Определяем тип выражения по его метке
+	// И вызываем для него соответствующую функцию
+	while (true)
 	{
-		// Пытаемся получить значение
-		if (scope->TryGet(key, &expr)) break;
+		stats.steps++;
+		if (profiler) profiler->Step(expr);
+		if (cancelled && cancelled->load(std::memory_order_relaxed)) throw EvaluationCancelled();
+		switch (expr->GetKind())
+		{
+			case ExpressionKind::Val:
+				result = Eval(static_cast<ValExpression*>(expr));
+				break;
+			case ExpressionKind::Var:
+				result = Eval(static_cast<VarExpression*>(expr));
+				break;
+			case ExpressionKind::Add:
+				result = Eval(static_cast<AddExpression*>(expr));
+				break;
+			case ExpressionKind::Function:
+				result = Eval(static_cast<FunctionExpression*>(expr));
+				break;
+			case ExpressionKind::Set:
+				result = Eval(static_cast<SetExpression*>(expr));
+				break;
+			case ExpressionKind::If:
+				expr = SelectBranch(static_cast<IfExpression*>(expr));
+				continue;
+			case ExpressionKind::Let:
+				expr = EnterLet(static_cast<LetExpression*>(expr));
+				continue;
+			case ExpressionKind::Call:
+				expr = EnterCall(static_cast<CallExpression*>(expr), depth);
+				continue;
+			case ExpressionKind::Block:
+				expr = EvalBlockPrefix(static_cast<BlockExpression*>(expr));
+				continue;
+			default:
+				throw UnknownExpressionException(expr);
+		}
+		break;
 	}
-	// Если значение найдено
-	// Возвращаем его копию
-	if (scope != nullptr) return expr->Clone();
-	// Иначе бросаем исключение
-	throw UndefinedVariableException(key);
+
+	LeaveScopes(depth);
+	if (profiler) profiler->Return(depth);
+	return result;
 }
 
-// Установить значение в текущей области видимости или вышележащих
-bool Evaluator::TrySetInEnv(std::string& key, Expression* expr)
+void Evaluator::GetValues(Expression* left, Expression* right, bool parallel, int& leftValue, int& rightValue)
 {
-	Scope* scope;
-	// Поднимаясь по цепочке областей видимости
-	// От дочерней к родительской
-	for (scope = CurrentScope(); scope != nullptr; scope = scope->GetParent())
+	if (parallel && pool && !profiler && forkDepth < maxForkDepth)
 	{
-		// Пытаемся установить значение
-		if (scope->TrySet(key, expr)) return true;
+		ForkValues(left, right, leftValue, rightValue);
+		return;
 	}
-	return false;
+	leftValue = GetValue(left);
+	rightValue = GetValue(right);
 }
 
-// Выполнить выражение
-Expression* Evaluator::Eval(Expression* expr)
+// Правый операнд вычисляет исполнитель задания в текущей области видимости
+// Операнды чисты, поэтому они только читают общие области видимости,
+// а свои области видимости каждый исполнитель создаёт в своей куче
+void Evaluator::ForkValues(Expression* left, Expression* right, int& leftValue, int& rightValue)
 {
-	// Определяем тип выражения
-	// И вызываем для него соответствующую функцию
-	if (auto valExpr = dynamic_cast<ValExpression*>(expr))
-		return Eval(valExpr);
-	
-	if (auto varExpr = dynamic_cast<VarExpression*>(expr)) 
-		return Eval(varExpr);
-
-	if (auto addExpr = dynamic_cast<AddExpression*>(expr)) 
-		return Eval(addExpr);
-
-	if (auto ifExpr = dynamic_cast<IfExpression*>(expr)) 
-		return Eval(ifExpr);
-
-	if (auto letExpr = dynamic_cast<LetExpression*>(expr)) 
-		return Eval(letExpr);
-
-	if (auto funcExpr = dynamic_cast<FunctionExpression*>(expr)) 
-		return Eval(funcExpr);
-
-	if (auto closureExpr = dynamic_cast<ClosureExpression*>(expr))
-		return Eval(closureExpr);
-
-	if (auto callExpr = dynamic_cast<CallExpression*>(expr))
-		return Eval(callExpr);
+	auto scope = CurrentScope();
+	size_t depth = forkDepth + 1;
+	std::atomic<bool> cancel(false);
+	int value = 0;
+	ExecutionStats taskStats;
+	TaskPool::Task task([&]()
+	{
+		Evaluator evaluator(heapOptions);
+		evaluator.pool = pool;
+		evaluator.maxForkDepth = maxForkDepth;
+		evaluator.forkDepth = depth;
+		evaluator.cancelled = &cancel;
+		evaluator.PushScope(scope);
+		value = evaluator.GetValue(right);
+		taskStats = evaluator.stats;
+	});
+
+	// Оба операнда вычисляются на следующем уровне вложенности
+	forkDepth++;
+	pool->Push(task);
+	try {
+		leftValue = GetValue(left);
+	}
+	catch (...)
+	{
+		// Задание, которое уже выполняется, прерывается, и выбрасывается ошибка левого операнда
+		forkDepth--;
+		if (!pool->Retract(task))
+		{
+			cancel = true;
+			try {
+				pool->Wait(task);
+			}
+			catch (...) {}
+		}
+		throw;
+	}
 
-	if (auto setExpr = dynamic_cast<SetExpression*>(expr)) 
-		return Eval(setExpr);
+	// Задание, которое никто не взял, выполняется в текущем потоке этим исполнителем
+	if (pool->Retract(task))
+	{
+		try {
+			rightValue = GetValue(right);
+		}
+		catch (...)
+		{
+			forkDepth--;
+			throw;
+		}
+		forkDepth--;
+		return;
+	}
 
-	if (auto blockExpr = dynamic_cast<BlockExpression*>(expr)) 
-		return Eval(blockExpr);
+	forkDepth--;
+	pool->Wait(task);
+	rightValue = value;
 
-	throw UnknownExpressionException(expr);
+	// Стэк исполнителя задания начинается с его внешней области видимости и текущей
+	stats.steps += taskStats.steps;
+	stats.calls += taskStats.calls;
+	stats.maxDepth = std::max(stats.maxDepth, scopeStack.size() + taskStats.maxDepth - 2);
 }
 
 // Выполняем выражение <val>
-// Просто копируем его
-Expression* Evaluator::Eval(ValExpression* val)
+// Значение хранится прямо в узле, выделять память не нужно
+Value Evaluator::Eval(ValExpression* val)
 {
-	return (ValExpression*) val->Clone();
+	return Value(val->GetValue());
 }
 
 // Выполняем выражение <var>
-Expression* Evaluator::Eval(VarExpression* var)
+Value Evaluator::Eval(VarExpression* var)
 {
-	auto id = var->GetId();
-	// Получаем значение переменной по её идентификатору
-	try {
-		return FromEnv(id);
-	}
-	catch (UndefinedVariableException &e)
-	{
-		e.SetPosition(var->GetPosition());
-		throw e;
-	}
-	
+	return ReadVariable(var);
+}
+
+// Получить ячейку переменной в текущей области видимости
+const Value& Evaluator::ReadVariable(VarExpression* var)
+{
+	// Адрес переменной должен быть вычислен заранее
+	auto& address = var->GetAddress();
+	if (!address.resolved)
+		throw UndefinedVariableException(var->GetId().GetName(), var->GetPosition());
+	return CurrentScope()->Lookup(address);
 }
 
 // Выполняем выражение <add>
-Expression* Evaluator::Eval(AddExpression* expr)
+Value Evaluator::Eval(AddExpression* expr)
 {
 	// Находим значение операндов
-	auto left = GetValue(Eval(expr->GetLeftOperand()));
-	auto right = GetValue(Eval(expr->GetRightOperand()));
+	int left, right;
+	GetValues(expr->GetLeftOperand(), expr->GetRightOperand(), expr->IsParallel(), left, right);
 	// И выполняем сложение
-	return new ValExpression(left + right, expr->GetPosition());
+	return Value(AddIntegers(left, right));
 }
 
 // Выполняем выражение <if>
-Expression* Evaluator::Eval(IfExpression* expr)
+// Выбранная ветвь находится в хвостовой позиции
+Expression* Evaluator::SelectBranch(IfExpression* expr)
 {
 	// Получаем значение операндов
-	auto val1 = GetValue(Eval(expr->GetLeftOperand()));
-	auto val2 = GetValue(Eval(expr->GetRightOperand()));
-	// Сравниваем их, выбираем выражение и исполняем его
-	return Eval(val1 > val2 ? expr->GetThenBranch() : expr->GetElseBranch());
+	int val1, val2;
+	GetValues(expr->GetLeftOperand(), expr->GetRightOperand(), expr->IsParallel(), val1, val2);
+	// Сравниваем их и выбираем выражение для исполнения
+	return val1 > val2 ? expr->GetThenBranch() : expr->GetElseBranch();
 }
 
 // Выполняем выражени <let>
-Expression* Evaluator::Eval(LetExpression* expr)
+// Тело находится в хвостовой позиции, область видимости
+// освобождается, когда завершится выполнение тела
+Expression* Evaluator::EnterLet(LetExpression* expr)
 {
-	// Получаем идентификатор переменной
-	auto id = expr->GetId(); 
-	// И её значение
-	auto value = Eval(expr->GetExpression());
 	// Создаём новую область видимости, с текущей в качестве родительской
-	Scope* scope = new Scope(CurrentScope());
+	auto scope = heap.CreateScope(CurrentScope(), 1);
 	// Помещаем её в стэк
 	PushScope(scope);
-	// И создаём в ней переменную
-	scope->AddValue(id, value);
-	// Затем выполняем в ней тело выражения
-	auto result = Eval(expr->GetBody());
-	// И удаляем область видимости
-	delete PopScope();
-	return result;
+	// Вычисляем значение переменной уже в новой области видимости,
+	// чтобы определяемая в нём функция могла ссылаться на саму себя
+	auto value = Eval(expr->GetExpression());
+	// И записываем его в ячейку переменной
+	scope->GetSlot(0) = value;
+	// Затем в ней будет выполнено тело выражения
+	return expr->GetBody();
 }
 
 // Выполняем выражение <function>
-Expression* Evaluator::Eval(FunctionExpression* func)
+Value Evaluator::Eval(FunctionExpression* func)
 {
 	// Замыкаем область видимости, в которой функция определяется
-	return new ClosureExpression(func, CurrentScope());
+	// Замыкание разделяет владение ею, поэтому она переживёт выход из неё
+	return Value(std::make_shared<Closure>(func, CurrentScope()));
 }
 
 // Выполняем выражение <call>
-Expression* Evaluator::Eval(CallExpression* expr)
+// Тело функции находится в хвостовой позиции
+// depth - глубина стэка областей видимости при входе в текущий вызов Eval
+Expression* Evaluator::EnterCall(CallExpression* expr, size_t depth)
 {
-	// Получаем тело функции
-	auto res = Eval(expr->GetCallable());
+	// Получаем вызываемое значение
+	// Обычно это переменная, и тогда замыкание читается прямо из её ячейки
+	Value temporary;
+	const Value* callable = &temporary;
+	if (expr->GetCallable()->GetKind() == ExpressionKind::Var)
+		callable = &ReadVariable(static_cast<VarExpression*>(expr->GetCallable()));
+	else
+		temporary = Eval(expr->GetCallable());
+
 	// И проверяем, соответствует ли оно типу
-	auto collable = dynamic_cast<FunctionExpression*>(res);
-	if (!collable) throw ExpressionIsNotCallableException(res);
-	// Проверяем, является ли она замыканием
-	auto closure = dynamic_cast<ClosureExpression*>(res);
+	if (callable->GetType() != ValueType::Closure)
+		throw ExpressionIsNotCallableException(expr->GetCallable());
+
+	// Из замыкания нужны только функция и область видимости её определения
+	// Берём их до вычисления аргумента, который может изменить переменную
+	auto& closure = callable->GetClosure();
+	auto function = closure->GetFunction();
+	auto environment = closure->GetScope();
 
 	// Получаем значение аргумента
 	auto argument = Eval(expr->GetArgument());
+	stats.calls++;
+
+	// Тело функции видит только область видимости определения функции,
+	// поэтому области видимости, созданные текущим вызовом Eval, больше не нужны
+	// Так хвостовой вызов не увеличивает стэк областей видимости
+	LeaveScopes(depth);
 
-	// Выбираем родительскую область видимости
-	// Если выражение - замыкание, то ей будет область видимости,
-	// где функция определена, если нет, то та, в которой происходит вызов
-	Scope* parentScope = closure ? closure->GetScope() : CurrentScope();
-	
 	// Создаём область видимости, в которой будет исполняться тело функции
-	Scope* scope = new Scope(parentScope);
-	// Создаём в ней переменную-аргумент
-	scope->AddValue(collable->GetArgument(), argument);
+	// Её родителем будет область видимости, где функция определена
+	auto scope = heap.CreateScope(std::move(environment), 1);
+	// Записываем в её ячейку аргумент
+	scope->GetSlot(0) = std::move(argument);
 	// И добавляем в стэк областей видимости
-	PushScope(scope);
+	PushScope(std::move(scope));
+	if (profiler) profiler->Call(function, depth);
 
-	// Затем исполняем в ней тело функции
-	auto result = Eval(collable->GetBody());
-
-	// А потом удаляем область видимости
-	delete PopScope();
-	return result;
+	// Затем в ней будет выполнено тело функции
+	return function->GetBody();
 }
 
 // Выполнить выражение <set>
-Expression* Evaluator::Eval(SetExpression* expr)
+Value Evaluator::Eval(SetExpression* expr)
 {
-	auto id = expr->GetId();
+	auto& address = expr->GetAddress();
+	if (!address.resolved)
+		throw UndefinedVariableException(expr->GetId().GetName(), expr->GetPosition());
 	auto value = Eval(expr->GetExpression());
-	if (!TrySetInEnv(id, value))
-	{
-		throw UndefinedVariableException(id, expr->GetPosition());
-	}
-	return new Expression(expr->GetPosition());
+	CurrentScope()->Lookup(address) = value;
+	return Value();
 }
 
 // Выполнить выражение <block>
-Expression* Evaluator::Eval(BlockExpression* block)
+// Блок не объявляет переменных и не создаёт области видимости
+// Выражения блока выполняются по порядку, результатом будет значение последнего,
+// которое находится в хвостовой позиции
+Expression* Evaluator::EvalBlockPrefix(BlockExpression* block)
 {
-	Expression* result = nullptr; // Результат выполнения блока
-	Scope* scope = new Scope(CurrentScope()); // Создаём область видимости для блока
-	PushScope(scope);
-	// Для каждого выражения в блоке
-	for (auto expr : block->GetExpressions())
+	auto& expressions = block->GetExpressions();
+	auto last = expressions.end() - 1;
+	for (auto expr = expressions.begin(); expr != last; expr++)
 	{
-		// Если оно не последние, то удаляем предыдущий результат
-		if (result) delete result;
-		// И выполняем выражение
-		result = Eval(expr);
+		Eval(*expr);
 	}
-	delete PopScope();
-	return result;
-}
-
-// Выполняем выражение <closure>
-// Просто создаём копию
-Expression* Evaluator::Eval(ClosureExpression* expression)
-{
-	return expression->Clone();
+	return *last;
 }
 
 // Текущая область видимости - вершина стэка областей
-Scope* Evaluator::CurrentScope() const
+const std::shared_ptr<Scope>& Evaluator::CurrentScope() const
 {
 	return scopeStack.top();
 }
 
 // Добавить новую область видимости в стэк
-void Evaluator::PushScope(Scope* scope)
+void Evaluator::PushScope(std::shared_ptr<Scope> scope)
 {
-	scopeStack.push(scope);
+	scopeStack.push(std::move(scope));
+	if (scopeStack.size() > stats.maxDepth) stats.maxDepth = scopeStack.size();
 }
 
 // Удалить вершину стэка областей видимости
-Scope* Evaluator::PopScope()
+// Область видимости освобождается, если на неё больше никто не ссылается
+void Evaluator::PopScope()
 {
-	auto result = scopeStack.top();
 	scopeStack.pop();
-	return result;
 }
 
-// Получить область видимости, в которой определена функция 
-Scope* ClosureExpression::GetScope()
+// Снять со стэка области видимости выше depth
+void Evaluator::LeaveScopes(size_t depth)
 {
-	return scope;
+	while (scopeStack.size() > depth)
+	{
+		PopScope();
+	}
 }
@@ -1,85 +1,91 @@
 #pragma once
 # include "AST.h"
-# include <unordered_map>
+# include "Value.h"
+# include "Scope.h"
+# include "Heap.h"
+# include "ExecutionStats.h"
+# include "Profiler.h"
+# include "Parallel.h"
+# include <atomic>
 # include <stack>
+# include <memory>
 
 // Описание для исполнителя и вспомогательных по отношению к нему классов
 
-class Scope;
-
-// Расширения FunctionExpression, позволяет замкнуть область видимости,
-// в которой определена функция
-class ClosureExpression : public FunctionExpression
-{
-	Scope* scope; // Замыкаемая область видимости
-public:
-	ClosureExpression(FunctionExpression* func, Scope* scope) : FunctionExpression(func->GetArgument(), func->GetBody()->Clone(), func->GetPosition()), scope(scope) {}
-	Scope* GetScope();
-};
-
+// Исполнитель AST
+// Выражения в хвостовой позиции (ветви <if>, последнее выражение <block>,
+// тело <let> и тело вызываемой функции) выполняются в цикле Eval,
+// а не рекурсивным вызовом, поэтому хвостовая рекурсия в программе
+// не расходует стэк C++, а области видимости завершённых вызовов
+// освобождаются до начала следующего
+// С пулом потоков правый операнд <add> и <if>, отмеченных PurityAnalyzer,
+// вычисляется заданием пула, пока левый вычисляется в текущем потоке.
+// Задание выполняет отдельный исполнитель со своей кучей, начиная
+// с текущей области видимости, которая остаётся на стэке до его завершения.
+// Ошибки и результат такие же, как при последовательном вычислении:
+// ошибка левого операнда отменяет правый, а ошибка правого выбрасывается,
+// только если левый вычислен успешно
 class Evaluator 
 {
-	std::stack<Scope*> scopeStack; // Стэк областей видимости
+	// Задания создаются только на первых уровнях вложенности параллельных
+	// вычислений, чтобы мелкие задания не стоили дороже своей работы:
+	// число заданий ограничено примерно TASKS_PER_THREAD на поток пула
+	static const size_t TASKS_PER_THREAD = 8;
+
+	HeapOptions heapOptions; // Настройки кучи, с ними создаются исполнители заданий
+	Heap heap; // Куча, в которой создаются области видимости
+	std::stack<std::shared_ptr<Scope>> scopeStack; // Стэк областей видимости
+	ExecutionStats stats; // Счётчики выполнения
+	Profiler* profiler = nullptr; // Профилировщик, если профилирование включено
+	TaskPool* pool = nullptr;     // Пул для параллельного вычисления операндов
+	size_t forkDepth = 0;         // Вложенность параллельных вычислений
+	size_t maxForkDepth = 0;      // Вложенность, после которой операнды вычисляются последовательно
+	const std::atomic<bool>* cancelled = nullptr; // Флаг отмены задания, которое выполняет исполнитель
 
 public:
-	Evaluator(Scope * global);
-	Evaluator();
-	~Evaluator();
+	Evaluator(const HeapOptions& options = HeapOptions());
 
-	Expression* Eval(Expression*);	// Выполнить выражение
+	Value Eval(Expression*);	// Выполнить выражение
 
-protected:
-	Scope* CurrentScope() const; // Текущая область видимости, вершина стэка
-	void PushScope(Scope*); // Добавить область видимости на вершину стэка
-	Scope* PopScope(); // Удалить область видимости с вершины
+	const HeapStats& GetHeapStats() const; // Счётчики кучи
+	const ExecutionStats& GetStats() const; // Счётчики выполнения
 
-	// Методы для выполнения конкретных выражений
-	Expression* Eval(ValExpression*);
-	Expression* Eval(VarExpression*);
-	Expression* Eval(AddExpression*);
-	Expression* Eval(IfExpression*);
-	Expression* Eval(LetExpression*);
-	Expression* Eval(FunctionExpression*);
-	Expression* Eval(CallExpression*);
-	Expression* Eval(SetExpression*);
-	Expression* Eval(BlockExpression*);
-	Expression* Eval(ClosureExpression*);
+	// Сообщать профилировщику о шагах и вызовах, nullptr - выключить профилирование
+	void SetProfiler(Profiler*);
 
-	int GetValue(Expression*); // Получить значение выражения
-	Expression* FromEnv(std::string&); // Получить значение из текущей области видимости
-	bool TrySetInEnv(std::string&, Expression*); // Попытка установить значение в текущей области видимости
-};
+	// Вычислять операнды параллельно на пуле потоков, nullptr - последовательно
+	// С профилировщиком операнды всегда вычисляются последовательно
+	void SetTaskPool(TaskPool*);
 
-// Класс - абстракция области видимости
-class Scope
-{
-	Scope * parentScope = nullptr; // Родительская области видимости
-	std::unordered_map<std::string, Expression*> values; // Значения, хранящиеся в области видимости
-public:
-	Scope() {}
-	Scope(Scope* parent) : parentScope(parent) {}
-	~Scope();
-
-	// Получить значение из текущей области видимости
-	// Если значение не будет найдено, будет выбрашено исключение
-	const Expression* GetValue(const std::string& key);
-
-	// Создать новое значение в текущей области видимости
-	void AddValue(const std::string& key, Expression* value);
-
-	// Установить значение в текущей области видимости
-	// Если значение не будет найдено, будет выбрашено исключение
-	void SetValue(const std::string& key, Expression* value);
+	// Вернуть исполнитель к внешней области видимости
+	// Нужно, чтобы выполнять следующую программу после ошибки,
+	// при которой области видимости прерванных вызовов остались на стэке
+	void Reset();
 
-	// Попытка получить значение из текущей области видимости
-	// Значение возращается через указатель value
-	// Если удачно, функция вернёт true, иначе false
-	bool TryGet(const std::string& key, Expression** value);
-
-	// Попытка установить значение в текущей области видимости
-	// Если удачно, функция вернёт true, иначе false
-	bool TrySet(const std::string& key, Expression* value);
+protected:
+	const std::shared_ptr<Scope>& CurrentScope() const; // Текущая область видимости, вершина стэка
+	void PushScope(std::shared_ptr<Scope>); // Добавить область видимости на вершину стэка
+	void PopScope(); // Удалить область видимости с вершины
+	void LeaveScopes(size_t depth); // Снять области видимости выше depth
 
-	// Родительская область видимости
-	Scope* GetParent();
-};
\ No newline at end of file
+	// Методы для выполнения конкретных выражений
+	Value Eval(ValExpression*);
+	Value Eval(VarExpression*);
+	Value Eval(AddExpression*);
+	Value Eval(FunctionExpression*);
+	Value Eval(SetExpression*);
+
+	// Методы для выражений, завершающихся выражением в хвостовой позиции
+	// Они выполняют всё, кроме него, и возвращают его для выполнения в цикле Eval
+	Expression* SelectBranch(IfExpression*);
+	Expression* EnterLet(LetExpression*);
+	Expression* EnterCall(CallExpression*, size_t depth);
+	Expression* EvalBlockPrefix(BlockExpression*);
+
+	int GetValue(Expression*); // Выполнить выражение и получить его целое значение
+	// Получить целые значения операндов <add> или <if>, параллельно, если parallel
+	void GetValues(Expression* left, Expression* right, bool parallel, int& leftValue, int& rightValue);
+	// Вычислить правый операнд в задании пула, пока левый вычисляется в текущем потоке
+	void ForkValues(Expression* left, Expression* right, int& leftValue, int& rightValue);
+	const Value& ReadVariable(VarExpression*); // Ячейка переменной, без копирования значения
+};
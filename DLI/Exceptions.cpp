@@ -5,6 +5,11 @@ std::string UnexpectedCharacterException::What() const
 	return position.ToString() + ": Unexpected character: " + (char)ch;
 }
 
+std::string InvalidNumberException::What() const
+{
+	return position.ToString() + ": Invalid number: " + text;
+}
+
 std::string UnexpectedEndOfFileException::What() const
 {
 	return position.ToString() + ": Unexpected end of file";
@@ -14,7 +19,7 @@ std::string UnexpectedTokenException::What() const
 {
 	std::string buff = "";
 	buff += position.ToString();
-	buff += " Unexpected token: " + unexpectedToken->ToString();
+	buff += " Unexpected token: " + unexpectedToken;
 	buff += "; Expected: ";
 	buff += GetExpectedString();
 	return buff;
@@ -22,33 +27,31 @@ std::string UnexpectedTokenException::What() const
 
 std::string UnexpectedTokenException::GetExpectedString() const
 {
-	if (expectedType == typeid(IdentifierToken))
-		return "Identifier";
-
-	if (expectedType == typeid(KeywordToken))
-		return "Keyword";
-
-	if (expectedType == typeid(ValueToken))
-		return "Value";
-
-	if (expectedType == typeid(OpenBracketToken))
-		return "Operator (";
-
-	if (expectedType == typeid(CloseBracketToken))
-		return "Operator )";
-
-	if (expectedType == typeid(AssignOperatorToken))
-		return "Operator =";
-
-	return "Unknown token";
+	switch (expectedType)
+	{
+		case TokenType::Identifier:
+			return "Identifier";
+		case TokenType::Keyword:
+			return "Keyword";
+		case TokenType::Value:
+			return "Value";
+		case TokenType::OpenBracket:
+			return "Operator (";
+		case TokenType::CloseBracket:
+			return "Operator )";
+		case TokenType::AssignOperator:
+			return "Operator =";
+		default:
+			return "Unknown token";
+	}
 }
 
-const Token* UnexpectedTokenException::GetToken() const
+const std::string& UnexpectedTokenException::GetToken() const
 {
 	return unexpectedToken;
 }
 
-const std::type_info& UnexpectedTokenException::GetExpectedType() const
+TokenType UnexpectedTokenException::GetExpectedType() const
 {
 	return expectedType;
 }
@@ -57,12 +60,17 @@ std::string UnexpectedTokenWithExpectedKeywordException::What() const
 {
 	std::string buff = "";
 	buff += position.ToString();
-	buff += " Unexpected token: " + unexpectedToken->ToString();
+	buff += " Unexpected token: " + unexpectedToken;
 	buff += "; Expected: ";
-	buff += "Keyword(" + expectedKeyword + ")";
+	buff += "Keyword(" + std::string(GetKeywordName(expectedKeyword)) + ")";
 	return buff;
 }
 
+std::string UnexpectedKeywordException::What() const
+{
+	return position.ToString() + " Unexpected keyword: " + std::string(GetKeywordName(keyword)) + "; Expected: expression";
+}
+
 const PositionInText& ParserException::GetPosition() const
 {
 	return position;
@@ -107,3 +115,8 @@ std::string ExpressionIsNotCallableException::What() const
 	return GetPositionPrefix() +
 		"Expression " + expression->ToString() + " isn't a callable expression";
 }
+
+std::string InvalidProgramFileException::What() const
+{
+	return "Invalid program file: " + reason;
+}
@@ -1,7 +1,6 @@
 #pragma once
 
 # include <string>
-# include <typeinfo>
 # include "Position.h"
 # include "Token.h"
 #include "AST.h"
@@ -115,6 +114,16 @@ public:
 	virtual std::string What() const;
 };
 
+// Исключение, происходящее, когда запись целого числа некорректна
+// или число не помещается в int
+class InvalidNumberException : public ParserException
+{
+	std::string text;
+public:
+	InvalidNumberException(const std::string& text, const PositionInText& position) : text(text), ParserException(position) {}
+	virtual std::string What() const;
+};
+
 // Исключение неожиданного конца ввода при синтаксическом анализе
 class UnexpectedEndOfFileException : public ParserException
 {
@@ -125,19 +134,23 @@ public:
 
 // Исключение, возникающее тогда, когда синтаксический анализатор
 // при чтении получает не ту лексему, которую ожидал
+// Лексемы живут только до чтения следующей, поэтому
+// исключение хранит строковое представление лексемы
 class UnexpectedTokenException : public ParserException
 {
 protected:
-	const Token* unexpectedToken;
-	const std::type_info& expectedType;
+	std::string unexpectedToken;
+	TokenType expectedType;
 
 	std::string GetExpectedString() const;
 public:
-	UnexpectedTokenException(const Token* unexpectedToken, const std::type_info& expected, const PositionInText& position)
+	UnexpectedTokenException(const Token* unexpectedToken, TokenType expected, const PositionInText& position)
+		: unexpectedToken(unexpectedToken->ToString()), expectedType(expected), ParserException(position) {};
+	UnexpectedTokenException(const std::string& unexpectedToken, TokenType expected, const PositionInText& position)
 		: unexpectedToken(unexpectedToken), expectedType(expected), ParserException(position) {};
 	virtual std::string What() const;
-	const Token* GetToken() const;
-	const std::type_info& GetExpectedType() const;
+	const std::string& GetToken() const;
+	TokenType GetExpectedType() const;
 };
 
 // Исключение, возникающее тогда, когда синтаксический анализатор
@@ -145,9 +158,31 @@ public:
 // и ожидаемой лексемой является кокретное ключевое слово.
 class UnexpectedTokenWithExpectedKeywordException : public UnexpectedTokenException
 {
-	const std::string expectedKeyword;
+	Keyword expectedKeyword;
+public:
+	UnexpectedTokenWithExpectedKeywordException(const Token* unexpectedToken, Keyword expected, const PositionInText& position)
+		: expectedKeyword(expected), UnexpectedTokenException(unexpectedToken, TokenType::Keyword, position) {};
+	UnexpectedTokenWithExpectedKeywordException(const std::string& unexpectedToken, Keyword expected, const PositionInText& position)
+		: expectedKeyword(expected), UnexpectedTokenException(unexpectedToken, TokenType::Keyword, position) {};
+	virtual std::string What() const;
+};
+
+// Исключение, возникающее тогда, когда выражение начинается
+// с ключевого слова, не обозначающего ни одну конструкцию языка (например, then)
+class UnexpectedKeywordException : public ParserException
+{
+	Keyword keyword;
+public:
+	UnexpectedKeywordException(Keyword keyword, const PositionInText& position) : keyword(keyword), ParserException(position) {}
+	virtual std::string What() const;
+};
+
+// Исключение, возникающее при загрузке программы в двоичном формате,
+// если данные повреждены или записаны в другой версии формата
+class InvalidProgramFileException : public InterpreterException
+{
+	std::string reason;
 public:
-	UnexpectedTokenWithExpectedKeywordException(const Token* unexpectedToken, const std::string& expected, const PositionInText& position)
-		: expectedKeyword(expected), UnexpectedTokenException(unexpectedToken, typeid(KeywordToken), position) {};
+	InvalidProgramFileException(const std::string& reason) : reason(reason) {}
 	virtual std::string What() const;
 };
\ No newline at end of file
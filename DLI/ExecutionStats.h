@@ -0,0 +1,17 @@
+#pragma once
+
+# include <cstddef>
+
+// Счётчики выполнения программы
+// Их ведут Evaluator, VirtualMachine и ThunkExecutor, но шаг у них разный:
+// у исполнителя это итерация цикла Eval (выполнение одного узла AST),
+// у виртуальной машины - одна инструкция байт-кода,
+// у ThunkExecutor - вызов функции узла из Eval (литералы и переменные
+// в операндах <add> и <if>, как и у исполнителя, шагами не считаются)
+struct ExecutionStats
+{
+	size_t steps = 0;    // Выполнено шагов
+	size_t calls = 0;    // Выполнено вызовов функций
+	size_t maxDepth = 0; // Наибольшая глубина стэка областей видимости (у VirtualMachine - стэка вызовов,
+	                     // у ThunkExecutor - вложенных вызовов Eval)
+};
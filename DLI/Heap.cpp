@@ -0,0 +1,232 @@
+#include "Heap.h"
+
+# include <algorithm>
+# include <chrono>
+# include <vector>
+
+namespace
+{
+	// Список свободных блоков потока
+	// Все области видимости одного размера, поэтому пул хранит блоки
+	// единственного размера - того, что был освобождён первым
+	struct FramePool
+	{
+		static const size_t MAX_FREE_FRAMES = 4096;
+
+		size_t frameSize = 0;
+		std::vector<void*> frames;
+
+		~FramePool()
+		{
+			for (auto frame : frames)
+			{
+				::operator delete(frame);
+			}
+		}
+	};
+
+	thread_local FramePool framePool;
+}
+
+void* AllocateFrame(size_t size)
+{
+	auto& pool = framePool;
+	if (size == pool.frameSize && !pool.frames.empty())
+	{
+		void* frame = pool.frames.back();
+		pool.frames.pop_back();
+		return frame;
+	}
+	return ::operator new(size);
+}
+
+void FreeFrame(void* frame, size_t size)
+{
+	auto& pool = framePool;
+	if (pool.frameSize == 0) pool.frameSize = size;
+	if (size == pool.frameSize && pool.frames.size() < FramePool::MAX_FREE_FRAMES)
+	{
+		pool.frames.push_back(frame);
+		return;
+	}
+	::operator delete(frame);
+}
+
+Heap::Heap(const HeapOptions& options)
+	: options(options), allocationLimit(options.collectionThreshold), collectionLimit(options.heapSize)
+{
+}
+
+// Перед уничтожением кучи освобождаем оставшиеся циклы,
+// а области видимости, на которые ещё ссылаются извне
+// (например, результат программы), отвязываем от кучи
+Heap::~Heap()
+{
+	Collect();
+	for (Scope* scope = first; scope != nullptr;)
+	{
+		Scope* next = scope->next;
+		scope->heap = nullptr;
+		scope->previous = scope->next = nullptr;
+		scope = next;
+	}
+}
+
+std::shared_ptr<Scope> Heap::CreateScope(std::shared_ptr<Scope> parent, size_t size)
+{
+	stats.scopesCreated++;
+	if (++allocations >= allocationLimit || stats.liveBytes >= collectionLimit)
+		Collect();
+	return std::allocate_shared<Scope>(FrameAllocator<Scope>(), this, std::move(parent), size);
+}
+
+// Сборка циклов пробным вычитанием ссылок
+void Heap::Collect()
+{
+	auto begin = std::chrono::steady_clock::now();
+
+	// Начальные значения - полные счётчики ссылок
+	// Замыкания, хранящиеся в ячейках, собираем в отдельный список
+	// Замыкания областей видимости других куч не могут замкнуть цикл
+	// в этой куче и пропускаются: их рабочие поля принадлежат той куче,
+	// которая может собирать мусор одновременно в другом потоке
+	std::vector<Closure*> closures;
+	for (Scope* scope = first; scope != nullptr; scope = scope->next)
+	{
+		scope->gcReferences = scope->weak_from_this().use_count();
+		scope->gcReachable = false;
+		for (size_t i = 0; i < scope->size; i++)
+		{
+			auto& value = scope->slots[i];
+			if (value.GetType() != ValueType::Closure) continue;
+			auto& closure = value.GetClosure();
+			if (!IsTracked(closure->GetScope().get())) continue;
+			if (!closure->gcListed)
+			{
+				closure->gcListed = true;
+				closure->gcReferences = closure.use_count();
+				closures.push_back(closure.get());
+			}
+		}
+	}
+
+	// Вычитаем ссылки между объектами кучи: из ячеек на замыкания,
+	// дочерних областей на родительские и замыканий на замкнутые области
+	for (Scope* scope = first; scope != nullptr; scope = scope->next)
+	{
+		for (size_t i = 0; i < scope->size; i++)
+		{
+			auto& value = scope->slots[i];
+			if (value.GetType() == ValueType::Closure && IsTracked(value.GetClosure()->GetScope().get()))
+				value.GetClosure()->gcReferences--;
+		}
+		if (IsTracked(scope->parentScope.get()))
+			scope->parentScope->gcReferences--;
+	}
+	for (auto closure : closures)
+	{
+		if (IsTracked(closure->GetScope().get()))
+			closure->GetScope()->gcReferences--;
+	}
+
+	// Объекты, на которые остались внешние ссылки, - корни
+	// Всё, что достижимо из них, живо
+	std::vector<Scope*> pending;
+	auto mark = [&](Scope* scope)
+	{
+		if (IsTracked(scope) && !scope->gcReachable)
+		{
+			scope->gcReachable = true;
+			pending.push_back(scope);
+		}
+	};
+	for (Scope* scope = first; scope != nullptr; scope = scope->next)
+	{
+		if (scope->gcReferences > 0) mark(scope);
+	}
+	for (auto closure : closures)
+	{
+		if (closure->gcReferences > 0) mark(closure->GetScope().get());
+		closure->gcListed = false;
+	}
+	while (!pending.empty())
+	{
+		auto scope = pending.back();
+		pending.pop_back();
+		mark(scope->parentScope.get());
+		for (size_t i = 0; i < scope->size; i++)
+		{
+			auto& value = scope->slots[i];
+			if (value.GetType() == ValueType::Closure)
+				mark(value.GetClosure()->GetScope().get());
+		}
+	}
+
+	// Недостижимые области видимости удерживаем, очищаем их ячейки и ссылки
+	// на родителей, разрывая циклы, и отпускаем - их освобождает подсчёт ссылок
+	std::vector<std::shared_ptr<Scope>> garbage;
+	for (Scope* scope = first; scope != nullptr; scope = scope->next)
+	{
+		if (!scope->gcReachable)
+			garbage.push_back(scope->shared_from_this());
+	}
+
+	size_t liveBytes = stats.liveBytes;
+	size_t liveScopes = stats.liveScopes;
+	for (auto& scope : garbage)
+	{
+		scope->Clear();
+	}
+	garbage.clear();
+
+	stats.scopesFreed += liveScopes - stats.liveScopes;
+	stats.bytesFreed += liveBytes - stats.liveBytes;
+	stats.collections++;
+	allocations = 0;
+
+	// Если после сборки живых областей видимости больше порогов,
+	// следующая сборка произойдёт, когда их число или объём удвоится,
+	// иначе при большой живой куче каждая сборка обходила бы её заново
+	allocationLimit = std::max(options.collectionThreshold, stats.liveScopes);
+	collectionLimit = std::max(options.heapSize, stats.liveBytes * 2);
+
+	auto end = std::chrono::steady_clock::now();
+	double pause = std::chrono::duration<double, std::milli>(end - begin).count();
+	stats.pauseTime += pause;
+	stats.maxPause = std::max(stats.maxPause, pause);
+}
+
+// Принадлежит ли область видимости этой куче
+bool Heap::IsTracked(const Scope* scope) const
+{
+	return scope != nullptr && scope->heap == this;
+}
+
+const HeapStats& Heap::GetStats() const
+{
+	return stats;
+}
+
+// Добавить область видимости в список кучи
+void Heap::Register(Scope* scope)
+{
+	scope->heap = this;
+	scope->next = first;
+	if (first) first->previous = scope;
+	first = scope;
+
+	stats.liveScopes++;
+	stats.liveBytes += scope->GetBytes();
+	stats.peakBytes = std::max(stats.peakBytes, stats.liveBytes);
+}
+
+// Удалить освобождаемую область видимости из списка кучи
+void Heap::Unregister(Scope* scope)
+{
+	if (scope->previous) scope->previous->next = scope->next;
+	else first = scope->next;
+	if (scope->next) scope->next->previous = scope->previous;
+
+	stats.liveScopes--;
+	stats.liveBytes -= scope->GetBytes();
+}
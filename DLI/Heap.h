@@ -0,0 +1,95 @@
+#pragma once
+
+# include "Scope.h"
+# include <cstddef>
+# include <memory>
+
+// Куча времени исполнения
+// Области видимости и замыкания освобождаются подсчётом ссылок,
+// но рекурсивная функция, объявленная через <let>, образует цикл:
+// область видимости хранит замыкание, а замыкание - область видимости.
+// Такие циклы находит сборщик: он вычитает из счётчиков ссылок
+// ссылки между объектами кучи, и всё, на что осталась ссылка извне
+// (стэк областей видимости, стэк значений, временные значения исполнителя),
+// считается корнем. Недостижимые из корней области видимости очищаются,
+// после чего подсчёт ссылок освобождает весь цикл.
+// Исполнители заданий параллельного Evaluator создают области видимости
+// в своих кучах, а общие области видимости только читают: ссылки
+// из других куч для сборщика внешние, а замыкания областей видимости
+// других куч он не трогает
+
+// Пул памяти для областей видимости
+// Освобождённые блоки не возвращаются распределителю C++, а складываются
+// в список свободных блоков потока и достаются следующим областям видимости,
+// так что вызов функции обычно не обращается к operator new.
+// Пул принадлежит потоку, а не куче, поэтому области видимости
+// могут пережить создавшую их кучу (например, в результате программы)
+void* AllocateFrame(size_t size);
+void FreeFrame(void* frame, size_t size);
+
+// Распределитель для std::allocate_shared, берущий память из пула
+template<class T> class FrameAllocator
+{
+public:
+	using value_type = T;
+
+	FrameAllocator() {}
+	template<class U> FrameAllocator(const FrameAllocator<U>&) {}
+
+	T* allocate(size_t count) { return static_cast<T*>(AllocateFrame(count * sizeof(T))); }
+	void deallocate(T* frame, size_t count) { FreeFrame(frame, count * sizeof(T)); }
+
+	template<class U> bool operator==(const FrameAllocator<U>&) const { return true; }
+	template<class U> bool operator!=(const FrameAllocator<U>&) const { return false; }
+};
+
+// Настройки кучи
+struct HeapOptions
+{
+	size_t heapSize = 64 * 1024 * 1024;  // Объём областей видимости в байтах, при превышении которого запускается сборка
+	size_t collectionThreshold = 100000; // Число созданных областей видимости, после которого запускается сборка
+};
+
+// Счётчики кучи
+struct HeapStats
+{
+	size_t scopesCreated = 0; // Создано областей видимости
+	size_t collections = 0;  // Выполнено сборок
+	size_t scopesFreed = 0;  // Освобождено сборщиком областей видимости
+	size_t bytesFreed = 0;   // Освобождено сборщиком байт
+	double pauseTime = 0;    // Суммарное время сборок, мс
+	double maxPause = 0;     // Самая долгая сборка, мс
+	size_t liveScopes = 0;   // Живых областей видимости
+	size_t liveBytes = 0;    // Занято ими байт
+	size_t peakBytes = 0;    // Наибольший занятый объём
+};
+
+class Heap
+{
+	HeapOptions options;
+	HeapStats stats;
+	Scope* first = nullptr;         // Список зарегистрированных областей видимости
+	size_t allocations = 0;         // Создано областей видимости после последней сборки
+	size_t allocationLimit;         // Число созданных областей, после которого запускается сборка
+	size_t collectionLimit;         // Объём, при превышении которого запускается сборка
+public:
+	Heap(const HeapOptions& options = HeapOptions());
+	Heap(const Heap&) = delete;
+	Heap& operator=(const Heap&) = delete;
+	~Heap();
+
+	// Создать область видимости в куче
+	// Перед созданием может быть выполнена сборка
+	std::shared_ptr<Scope> CreateScope(std::shared_ptr<Scope> parent, size_t size);
+
+	// Найти и освободить недостижимые циклы
+	void Collect();
+
+	const HeapStats& GetStats() const;
+
+protected:
+	friend class Scope;
+	void Register(Scope*);
+	void Unregister(Scope*);
+	bool IsTracked(const Scope*) const;
+};
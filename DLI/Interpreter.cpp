@@ -0,0 +1,126 @@
+#include "Interpreter.h"
+
+# include "BufferLexer.h"
+# include "Parser.h"
+# include "Resolver.h"
+# include "Optimizer.h"
+# include "Bytecode.h"
+# include "Serialization.h"
+# include "Exceptions.h"
+# include <chrono>
+# include <exception>
+# include <string_view>
+
+Interpreter::Interpreter(const InterpreterOptions& options)
+	: options(options), ownSymbols(std::make_unique<SymbolTable>()), symbols(*ownSymbols),
+	evaluator(options.heap), machine(options.heap), thunkExecutor(options.heap), cache(nullptr)
+{
+}
+
+Interpreter::Interpreter(SymbolTable& symbols, const InterpreterOptions& options, ProgramCache* cache)
+	: options(options), symbols(symbols), evaluator(options.heap), machine(options.heap),
+	thunkExecutor(options.heap), cache(cache)
+{
+}
+
+ProgramResult Interpreter::Run(const char* begin, const char* end)
+{
+	ProgramResult result;
+	auto start = std::chrono::steady_clock::now();
+
+	// Исключения ссылаются на узлы AST, поэтому программа из кэша
+	// удерживается до конца обработки ошибки: иначе другой поток
+	// мог бы вытеснить и освободить её раньше
+	std::shared_ptr<const PreparedProgram> program;
+
+	try {
+		if (cache)
+		{
+			// Программы с ошибками разбора в кэш не попадают
+			std::string_view source(begin, end - begin);
+			program = cache->Find(source);
+			if (!program)
+			{
+				auto prepared = std::make_shared<PreparedProgram>();
+				prepared->expression = Prepare(begin, end, prepared->arena);
+				if (options.useVirtualMachine)
+					prepared->bytecode = std::make_unique<Program>(Compiler().Compile(prepared->expression));
+				else if (options.useThunks)
+					prepared->thunks = ThunkCompiler().Compile(prepared->expression);
+				cache->Insert(source, prepared);
+				program = std::move(prepared);
+			}
+			result.text = Execute(program->expression, program->bytecode.get(), program->thunks.get());
+		}
+		else
+		{
+			result.text = Execute(Prepare(begin, end, arena), nullptr, nullptr);
+		}
+		result.succeeded = true;
+	}
+	catch (InterpreterException& e)
+	{
+		result.text = e.What();
+	}
+	catch (std::exception& e)
+	{
+		result.text = e.what();
+	}
+
+	if (!result.succeeded) evaluator.Reset();
+	arena.Reset();
+
+	result.time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	return result;
+}
+
+ProgramResult Interpreter::Run(const std::string& source)
+{
+	return Run(source.data(), source.data() + source.size());
+}
+
+// Программа может быть задана и текстом, и сохранённым AST
+Expression* Interpreter::Prepare(const char* begin, const char* end, Arena& arena)
+{
+	Expression* expr;
+	if (IsSerializedProgram(begin, end - begin))
+	{
+		expr = DeserializeProgram(begin, end - begin, arena, symbols);
+	}
+	else
+	{
+		BufferLexer lexer(symbols, begin, end);
+		Parser parser(lexer, arena);
+		expr = parser.Parse();
+	}
+
+	Resolver resolver;
+	resolver.Resolve(expr);
+	if (options.optimize)
+	{
+		Optimizer optimizer(arena);
+		expr = optimizer.Optimize(expr);
+		resolver.Resolve(expr);
+	}
+	return expr;
+}
+
+// Результат переводится в текст сразу, пока AST программы существует,
+// так как замыкание ссылается на узел AST своей функции
+std::string Interpreter::Execute(Expression* expr, const Program* bytecode, const ThunkProgram* thunks)
+{
+	if (!options.useVirtualMachine)
+	{
+		if (!options.useThunks)
+			return evaluator.Eval(expr).ToString();
+		if (thunks)
+			return thunkExecutor.Run(*thunks).ToString();
+		return thunkExecutor.Run(*ThunkCompiler().Compile(expr)).ToString();
+	}
+	if (bytecode)
+		return machine.Run(*bytecode).ToString();
+
+	Compiler compiler;
+	auto program = compiler.Compile(expr);
+	return machine.Run(program).ToString();
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+# include "SymbolTable.h"
+# include "Arena.h"
+# include "Heap.h"
+# include "Evaluator.h"
+# include "VirtualMachine.h"
+# include "ThunkExecutor.h"
+# include "ProgramCache.h"
+# include <memory>
+# include <string>
+
+// Настройки интерпретатора
+struct InterpreterOptions
+{
+	bool optimize = true;           // Оптимизировать AST перед выполнением
+	bool useVirtualMachine = false; // Выполнять байт-код на VirtualMachine, а не AST
+	bool useThunks = false;         // Выполнять дерево узлов ThunkCompiler на ThunkExecutor
+	HeapOptions heap;               // Настройки кучи исполнителя
+};
+
+// Результат выполнения одной программы
+struct ProgramResult
+{
+	bool succeeded = false; // Программа выполнена без ошибок
+	std::string text;       // Результат программы или описание ошибки
+	double time = 0;        // Время разбора и выполнения, мс
+};
+
+// Интерпретатор для выполнения многих программ подряд
+// Таблица символов, арена и исполнитель создаются один раз
+// и переиспользуются: арена сохраняет свой первый блок,
+// куча исполнителя - освобождённые области видимости.
+// Программы не видят переменных друг друга, каждая выполняется
+// во внешней области видимости исполнителя.
+// Таблица символов накапливает имена всех выполненных программ.
+// Интерпретатор выполняет программы в одном потоке, но интерпретаторы
+// разных потоков могут разделять одну таблицу символов и кэш программ.
+// С кэшем повторно выполняемая программа не разбирается заново:
+// подготовленная программа берётся из кэша
+class Interpreter
+{
+	InterpreterOptions options;
+	std::unique_ptr<SymbolTable> ownSymbols; // Собственная таблица, если общая не передана
+	SymbolTable& symbols;
+	Arena arena;              // Арена AST текущей программы, очищается после каждой
+	Evaluator evaluator;
+	VirtualMachine machine;
+	ThunkExecutor thunkExecutor;
+	ProgramCache* cache;      // Кэш подготовленных программ, если он используется
+public:
+	Interpreter(const InterpreterOptions& options = InterpreterOptions());
+	// Программы кэша ссылаются на символы таблицы symbols,
+	// поэтому кэш используется только с общей таблицей символов
+	Interpreter(SymbolTable& symbols, const InterpreterOptions& options = InterpreterOptions(), ProgramCache* cache = nullptr);
+	Interpreter(const Interpreter&) = delete;
+	Interpreter& operator=(const Interpreter&) = delete;
+
+	// Выполнить программу из текста [begin, end)
+	// Ошибки программы не выбрасываются, а возвращаются в результате
+	ProgramResult Run(const char* begin, const char* end);
+	ProgramResult Run(const std::string& source);
+
+protected:
+	// Разобрать программу в арене, разрешить имена и оптимизировать
+	Expression* Prepare(const char* begin, const char* end, Arena&);
+
+	// Выполнить подготовленную программу и вернуть результат в виде текста
+	// Если байт-код или дерево узлов не переданы, они компилируются
+	// при выполнении на VirtualMachine или ThunkExecutor
+	std::string Execute(Expression*, const Program* bytecode, const ThunkProgram* thunks);
+};
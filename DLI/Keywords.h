@@ -0,0 +1,80 @@
+#pragma once
+
+# include <string_view>
+
+// Ключевые слова языка
+// Лексический анализатор распознаёт их с помощью совершенной хэш-функции,
+// построенной во время компиляции, а синтаксический анализатор выбирает
+// метод разбора по значению перечисления
+
+enum class Keyword : unsigned char
+{
+	Val, Var, Add, If, Then, Else, Let, In, Function, Call, Set, Block,
+	None // Слово не является ключевым
+};
+
+// Записи ключевых слов в порядке перечисления Keyword
+constexpr std::string_view KEYWORDS[] = {
+	"val", "var", "add", "if", "then", "else",
+	"let", "in", "function", "call", "set", "block"
+};
+
+constexpr unsigned KEYWORD_COUNT = sizeof(KEYWORDS) / sizeof(KEYWORDS[0]);
+constexpr unsigned KEYWORD_TABLE_SIZE = 16;
+
+static_assert(KEYWORD_COUNT == static_cast<unsigned>(Keyword::None), "KEYWORDS doesn't match Keyword");
+
+// Хэш слова по его длине, первому и последнему символу
+// Коэффициенты подобраны так, что для ключевых слов коллизий нет
+constexpr unsigned KeywordHash(std::string_view word)
+{
+	return (static_cast<unsigned>(word.size())
+		+ 5 * static_cast<unsigned char>(word.front())
+		+ 7 * static_cast<unsigned char>(word.back())) % KEYWORD_TABLE_SIZE;
+}
+
+// Таблица ключевых слов, индексируемая хэшем
+struct KeywordTable
+{
+	Keyword slots[KEYWORD_TABLE_SIZE] = {};
+	bool perfect = true; // Нет ли коллизий
+};
+
+constexpr KeywordTable BuildKeywordTable()
+{
+	KeywordTable table;
+	for (unsigned i = 0; i < KEYWORD_TABLE_SIZE; i++)
+		table.slots[i] = Keyword::None;
+
+	for (unsigned i = 0; i < KEYWORD_COUNT; i++)
+	{
+		auto& slot = table.slots[KeywordHash(KEYWORDS[i])];
+		if (slot != Keyword::None) table.perfect = false;
+		slot = static_cast<Keyword>(i);
+	}
+	return table;
+}
+
+constexpr KeywordTable KEYWORD_TABLE = BuildKeywordTable();
+
+static_assert(KEYWORD_TABLE.perfect, "KeywordHash has collisions, choose other coefficients");
+
+// Найти ключевое слово по записи
+// Хэш указывает единственного кандидата, который сверяется со словом целиком
+constexpr Keyword FindKeyword(std::string_view word)
+{
+	if (word.empty()) return Keyword::None;
+	Keyword keyword = KEYWORD_TABLE.slots[KeywordHash(word)];
+	if (keyword == Keyword::None || KEYWORDS[static_cast<unsigned>(keyword)] != word)
+		return Keyword::None;
+	return keyword;
+}
+
+// Запись ключевого слова
+constexpr std::string_view GetKeywordName(Keyword keyword)
+{
+	return keyword == Keyword::None ? "" : KEYWORDS[static_cast<unsigned>(keyword)];
+}
+
+static_assert(FindKeyword("function") == Keyword::Function, "FindKeyword is broken");
+static_assert(FindKeyword("fun") == Keyword::None, "FindKeyword is broken");
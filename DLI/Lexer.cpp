@@ -2,20 +2,66 @@
 
 # include <string>
 # include <vector>
-# include <list>
 # include <iostream>
-# include <cctype>
-# include <algorithm>
 # include <exception>
+# include <charconv>
 
 # include "Exceptions.h"
+# include "CharScanner.h"
 
-// Выполнить лексический анализ
-std::list<Token*> Lexer::Tokenize()
+Lexer::~Lexer()
 {
-	// Пока не достигнут конец ввода
-	while (!in.eof() && in.peek() >= 0)
+	Destroy(current);
+	Destroy(pending);
+}
+
+// Прочитать следующую лексему
+// Выданная ранее лексема больше не нужна, и её память освобождается
+Token* Lexer::Next()
+{
+	Destroy(current);
+	Fill();
+	std::swap(current, pending);
+	return current;
+}
+
+// Посмотреть следующую лексему
+Token* Lexer::Peek()
+{
+	Fill();
+	return pending;
+}
+
+void Lexer::Destroy(Token*& token)
+{
+	if (token) token->~Token();
+	token = nullptr;
+}
+
+// Продвигаем конечный автомат, пока не появится лексема
+void Lexer::Fill()
+{
+	// Пока нет готовых лексем и не достигнут конец ввода
+	while (!pending && !finished)
 	{
+		if (in.eof() || in.peek() < 0)
+		{
+			finished = true;
+
+			// Заканчиваем чтение целого
+			if (state == LexerState::ReadInt && buff.length() > 0)
+			{
+				EmitValueToken();
+			}
+
+			// Заканчиваем чтение строки
+			if (state == LexerState::ReadWord && buff.length() > 0)
+			{
+				EmitWordToken();
+			}
+			return;
+		}
+
 		// Вызываем метод для текущего состояния конечного автомата
 		switch (state)
 		{
@@ -29,20 +75,6 @@ std::list<Token*> Lexer::Tokenize()
 				ReadWordState();
 		}
 	}
-
-	// Заканчиваем чтение целого
-	if (state == LexerState::ReadInt && buff.length() > 0)
-	{
-		tokens.push_back((Token*)CreateValueToken());
-	}
-
-	// Заканчиваем чтение строки
-	if (state == LexerState::ReadWord && buff.length() > 0)
-	{
-		tokens.push_back(CreateWordToken());
-	}
-
-	return tokens;
 }
 
 // Состояние - чтение целого числа
@@ -51,14 +83,13 @@ void Lexer::ReadIntState()
 	int ch = GetChar();
 	if (ch < 0) return;
 
-	if (isdigit(ch))
+	if (IsDigit(ch))
 	{
 		buff += ch;
 		return;
 	} 
 	
-	Token * token = CreateValueToken();
-	tokens.push_back(token);
+	EmitValueToken();
 	PutBack(ch);
 	state = LexerState::WaitToken;
 }
@@ -69,13 +100,12 @@ void Lexer::ReadWordState()
 	int ch = GetChar();
 	if (ch < 0) return;
 
-	if (isalnum(ch)) {
+	if (IsAlnum(ch)) {
 		buff += ch;
 		return;
 	}
 
-	Token* token = CreateWordToken();
-	tokens.push_back(token);
+	EmitWordToken();
 	PutBack(ch);
 	state = LexerState::WaitToken;
 }
@@ -87,37 +117,37 @@ void Lexer::WaitForToken()
 	if (ch < 0) return;
 
 	// Пропускаем пробелы, символы табуляции и перевода строки
-	if (isspace(ch) || isblank(ch)) return;
+	if (IsSpace(ch)) return;
 
 	// Если буква символ или знак минуса
-	if (isalnum(ch) || ch == MINUS)
+	if (IsAlnum(ch) || ch == MINUS)
 	{
 		buff += ch; // Добавляем символ в буфер
 		bufferBeginingPosition = position;
-		state = isalpha(ch)  // И выбираем новое состояние автомата
+		state = IsLetter(ch)  // И выбираем новое состояние автомата
 			? LexerState::ReadWord // В зависимости от того, что будем считывать
 			: LexerState::ReadInt;
 		return;
 	}
 
 	// Если скобки или оператор "="
-	// То просто добавляем соответсвующие им лексемы в список
+	// То просто создаём соответсвующие им лексемы
 
 	if (ch == OPEN_BRACKET) 
 	{
-		tokens.push_back((Token*)(new OpenBracketToken(position)));
+		Emit<OpenBracketToken>(position);
 		return;
 	}
 
 	if (ch == CLOSE_BRACKET)
 	{
-		tokens.push_back((Token*)(new CloseBracketToken(position)));
+		Emit<CloseBracketToken>(position);
 		return;
 	}
 
 	if (ch == ASSIGN_OPERATOR)
 	{
-		tokens.push_back((Token*)(new AssignOperatorToken(position)));
+		Emit<AssignOperatorToken>(position);
 		return;
 	}
 
@@ -153,23 +183,35 @@ void Lexer::PutBack(int ch)
 
 // Создает лексему для целого числа
 // На основе содержимого буфера чтения 
-ValueToken* Lexer::CreateValueToken()
+void Lexer::EmitValueToken()
 {
-	ValueToken* token = new ValueToken(std::stoi(buff), bufferBeginingPosition);
+	Emit<ValueToken>(ParseInteger(buff, bufferBeginingPosition), bufferBeginingPosition);
 	buff = "";
-	return token;
 }
 
 // Создаёт лексему для ключевого слова или идентификатора
 // В зависимости от того, лежит ли в буфер строка
 // Идентичная одному из ключевых слов
-Token* Lexer::CreateWordToken()
+// Идентификаторы заносятся в таблицу символов
+void Lexer::EmitWordToken()
 {
-	bool isKeyword = std::find(keywords.begin(), keywords.end(), buff) != keywords.end();
-	Token* token = isKeyword
-		? (Token*) new KeywordToken(buff, bufferBeginingPosition)
-		: (Token*) new IdentifierToken(buff, bufferBeginingPosition);
+	Keyword keyword = FindKeyword(buff);
+	if (keyword != Keyword::None)
+		Emit<KeywordToken>(keyword, bufferBeginingPosition);
+	else
+		Emit<IdentifierToken>(symbols.Intern(buff), bufferBeginingPosition);
 
-	buff = "";
-	return token;
-}
\ No newline at end of file
+	buff.clear();
+}
+
+// Разобрать запись целого числа
+// Минус без цифр и числа, не помещающиеся в int, считаются ошибкой
+int ParseInteger(std::string_view text, const PositionInText& position)
+{
+	int value = 0;
+	auto end = text.data() + text.size();
+	auto result = std::from_chars(text.data(), end, value);
+	if (result.ec != std::errc() || result.ptr != end)
+		throw InvalidNumberException(std::string(text), position);
+	return value;
+}
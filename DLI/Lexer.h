@@ -1,12 +1,16 @@
 #pragma once
 
 # include <string>
+# include <string_view>
 # include <vector>
-# include <list>
 # include <stack>
+# include <utility>
+# include <new>
 # include <iostream>
 # include "Position.h"
 # include "Token.h"
+# include "TokenStream.h"
+# include "SymbolTable.h"
 
 
 // Используемые операторы
@@ -16,6 +20,10 @@ const char ASSIGN_OPERATOR = '=';
 const char MINUS = '-';
 
 
+// Получить значение целого числа по его записи
+// Если запись некорректна, будет выбрашено InvalidNumberException
+int ParseInteger(std::string_view text, const PositionInText& position);
+
 // Состояния синтаксического анализатора
 enum class LexerState {
 	WaitToken,     // Ожидание начала новой лексемы
@@ -23,29 +31,57 @@ enum class LexerState {
 	ReadWord       // Чтение слова
 };
 
-class Lexer
+// Лексический анализатор
+// Читает символы по мере того, как синтаксический анализатор запрашивает лексемы,
+// поэтому в памяти одновременно находятся не больше двух лексем: выданная
+// и просмотренная вперёд. Они создаются по очереди в двух областях памяти
+// внутри анализатора, без обращения к куче для каждой лексемы
+class Lexer : public TokenStream
 {
-	std::vector<std::string> &keywords;    // Список ключевых слов
+	SymbolTable &symbols;                  // Таблица символов для идентификаторов
 	std::istream &in;                      // Входной поток символов
-	std::list<Token*> tokens;              // Выходной список лексем
+	TokenStorage storage[2];               // Память выданной и просмотренной лексем
+	Token* current = nullptr;              // Последняя выданная лексема
+	Token* pending = nullptr;              // Прочитанная, но ещё не выданная лексема
+	bool finished = false;                 // Достигнут ли конец ввода
 	LexerState state;                      // Состояние анализатора
 	std::string buff;                      // Буфер чтения лексемы
 	PositionInText bufferBeginingPosition; // Позиция начала буфера в тексте
 	PositionInText position = { 1, 0 };    // Позиция в тексте
 	std::stack<unsigned int> rowLengths;   // Стэк длины строк
 public:
-	Lexer(std::vector<std::string>& keywords, std::istream& in) : in(in), keywords(keywords), state(LexerState::WaitToken){};
+	Lexer(SymbolTable& symbols, std::istream& in) : in(in), symbols(symbols), state(LexerState::WaitToken){};
+	Lexer(const Lexer&) = delete;
+	Lexer& operator=(const Lexer&) = delete;
+	~Lexer();
 	
-	// Выполняет лексический анализ
-	std::list<Token*> Tokenize();
+	// Прочитать следующую лексему
+	virtual Token* Next();
+
+	// Посмотреть следующую лексему, не читая её
+	virtual Token* Peek();
 protected:
+	// Читать ввод, пока не будет получена хотя бы одна лексема
+	// или не закончится ввод
+	void Fill();
+
 	void ReadIntState();
 	void ReadWordState();
 	void WaitForToken();
 
+	// Создать прочитанную лексему в области памяти, не занятой выданной
+	template<class T, class... Args> void Emit(Args&&... args);
+	void Destroy(Token*&); // Уничтожить лексему
+
 	int GetChar();
 	void PutBack(int);
 
-	ValueToken* CreateValueToken();
-	Token* CreateWordToken();
-};
\ No newline at end of file
+	void EmitValueToken();
+	void EmitWordToken();
+};
+
+template<class T, class... Args> inline void Lexer::Emit(Args&&... args)
+{
+	void* memory = current == (Token*)&storage[0] ? &storage[1] : &storage[0];
+	pending = new (memory) T(std::forward<Args>(args)...);
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include "MappedFile.h"
+
+# include <stdexcept>
+
+#ifdef _WIN32
+# define NOMINMAX
+# include <windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path)
+{
+	file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		file = nullptr;
+		throw std::runtime_error("File doesn't exist");
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize))
+	{
+		CloseHandle(file);
+		throw std::runtime_error("Can't get file size");
+	}
+	size = (size_t)fileSize.QuadPart;
+
+	// Пустой файл отобразить нельзя, он просто не содержит символов
+	if (size == 0) return;
+
+	mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping != nullptr)
+		data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (data == nullptr)
+	{
+		if (mapping != nullptr) CloseHandle(mapping);
+		CloseHandle(file);
+		throw std::runtime_error("Can't map file");
+	}
+}
+
+MappedFile::~MappedFile()
+{
+	if (data != nullptr) UnmapViewOfFile(data);
+	if (mapping != nullptr) CloseHandle(mapping);
+	if (file != nullptr) CloseHandle(file);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path)
+{
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) throw std::runtime_error("File doesn't exist");
+
+	struct stat info;
+	if (fstat(fd, &info) != 0)
+	{
+		close(fd);
+		throw std::runtime_error("Can't get file size");
+	}
+	size = (size_t)info.st_size;
+
+	// Пустой файл отобразить нельзя, он просто не содержит символов
+	if (size > 0)
+	{
+		void* memory = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (memory == MAP_FAILED)
+		{
+			close(fd);
+			throw std::runtime_error("Can't map file");
+		}
+		// Файл читается последовательно от начала до конца
+		madvise(memory, size, MADV_SEQUENTIAL);
+		data = static_cast<const char*>(memory);
+	}
+	// Отображение остаётся действительным и после закрытия файла
+	close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+	if (data != nullptr) munmap(const_cast<char*>(data), size);
+}
+
+#endif
+
+const char* MappedFile::GetData() const
+{
+	return data;
+}
+
+size_t MappedFile::GetSize() const
+{
+	return size;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+# include <cstddef>
+# include <string>
+
+// Файл, отображённый в память только для чтения
+// Позволяет лексическому анализатору читать исходный текст
+// как непрерывный массив символов, без копирования
+class MappedFile
+{
+	const char* data = nullptr; // Начало отображения
+	size_t size = 0;            // Размер файла
+#ifdef _WIN32
+	void* file = nullptr;       // Дескриптор файла
+	void* mapping = nullptr;    // Дескриптор отображения
+#endif
+public:
+	// Отобразить файл в память
+	// Если файл не удаётся открыть, будет выбрашено std::runtime_error
+	explicit MappedFile(const std::string& path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const char* GetData() const;
+	size_t GetSize() const;
+};
@@ -0,0 +1,196 @@
+#include "Optimizer.h"
+
+# include "Value.h"
+
+Optimizer::Optimizer(Arena& arena) : arena(arena)
+{
+}
+
+const OptimizerStats& Optimizer::GetStats() const
+{
+	return stats;
+}
+
+// Оптимизировать выражение
+Expression* Optimizer::Optimize(Expression* expr)
+{
+	switch (expr->GetKind())
+	{
+		case ExpressionKind::Add:
+			return Optimize(static_cast<AddExpression*>(expr));
+		case ExpressionKind::If:
+			return Optimize(static_cast<IfExpression*>(expr));
+		case ExpressionKind::Let:
+			return Optimize(static_cast<LetExpression*>(expr));
+		case ExpressionKind::Function:
+			return Optimize(static_cast<FunctionExpression*>(expr));
+		case ExpressionKind::Call:
+			return Optimize(static_cast<CallExpression*>(expr));
+		case ExpressionKind::Set:
+			return Optimize(static_cast<SetExpression*>(expr));
+		case ExpressionKind::Block:
+			return Optimize(static_cast<BlockExpression*>(expr));
+		default:
+			// <val> и <var> оптимизировать нечего
+			return expr;
+	}
+}
+
+// Сумма двух констант - константа
+Expression* Optimizer::Optimize(AddExpression* expr)
+{
+	auto left = Optimize(expr->GetLeftOperand());
+	auto right = Optimize(expr->GetRightOperand());
+
+	if (left->GetKind() == ExpressionKind::Val && right->GetKind() == ExpressionKind::Val)
+	{
+		stats.foldedAdds++;
+		int value = AddIntegers(static_cast<ValExpression*>(left)->GetValue(), static_cast<ValExpression*>(right)->GetValue());
+		return arena.Create<ValExpression>(value, expr->GetPosition());
+	}
+
+	if (left == expr->GetLeftOperand() && right == expr->GetRightOperand())
+		return expr;
+	return arena.Create<AddExpression>(left, right, expr->GetPosition());
+}
+
+// При константных операндах ветвь известна заранее
+Expression* Optimizer::Optimize(IfExpression* expr)
+{
+	auto left = Optimize(expr->GetLeftOperand());
+	auto right = Optimize(expr->GetRightOperand());
+
+	if (left->GetKind() == ExpressionKind::Val && right->GetKind() == ExpressionKind::Val)
+	{
+		stats.foldedIfs++;
+		bool then = static_cast<ValExpression*>(left)->GetValue() > static_cast<ValExpression*>(right)->GetValue();
+		return Optimize(then ? expr->GetThenBranch() : expr->GetElseBranch());
+	}
+
+	auto thenBranch = Optimize(expr->GetThenBranch());
+	auto elseBranch = Optimize(expr->GetElseBranch());
+	if (left == expr->GetLeftOperand() && right == expr->GetRightOperand()
+		&& thenBranch == expr->GetThenBranch() && elseBranch == expr->GetElseBranch())
+		return expr;
+	return arena.Create<IfExpression>(left, right, thenBranch, elseBranch, expr->GetPosition());
+}
+
+// <let> с неиспользуемой переменной и чистым значением заменяется телом
+Expression* Optimizer::Optimize(LetExpression* expr)
+{
+	auto expression = Optimize(expr->GetExpression());
+	auto body = Optimize(expr->GetBody());
+
+	// Значение, свёрнутое в функцию, увидело бы саму переменную <let>
+	// вместо внешней одноимённой, поэтому оно остаётся прежним
+	if (expression->GetKind() == ExpressionKind::Function && expr->GetExpression()->GetKind() != ExpressionKind::Function)
+		expression = expr->GetExpression();
+
+	if (IsPure(expression) && !IsUsed(expr->GetId(), body))
+	{
+		stats.removedLets++;
+		return body;
+	}
+
+	if (expression == expr->GetExpression() && body == expr->GetBody())
+		return expr;
+	return arena.Create<LetExpression>(expr->GetId(), expression, body, expr->GetPosition());
+}
+
+Expression* Optimizer::Optimize(FunctionExpression* expr)
+{
+	auto body = Optimize(expr->GetBody());
+	if (body == expr->GetBody())
+		return expr;
+	return arena.Create<FunctionExpression>(expr->GetArgument(), body, expr->GetPosition());
+}
+
+Expression* Optimizer::Optimize(CallExpression* expr)
+{
+	auto callable = Optimize(expr->GetCallable());
+	auto argument = Optimize(expr->GetArgument());
+	if (callable == expr->GetCallable() && argument == expr->GetArgument())
+		return expr;
+	return arena.Create<CallExpression>(callable, argument, expr->GetPosition());
+}
+
+Expression* Optimizer::Optimize(SetExpression* expr)
+{
+	auto expression = Optimize(expr->GetExpression());
+	if (expression == expr->GetExpression())
+		return expr;
+	return arena.Create<SetExpression>(expr->GetId(), expression, expr->GetPosition());
+}
+
+// Вложенные выражения блока заменяются на месте,
+// массив выражений блока принадлежит только ему
+Expression* Optimizer::Optimize(BlockExpression* block)
+{
+	for (auto& expr : block->GetExpressions())
+	{
+		expr = Optimize(expr);
+	}
+	return block;
+}
+
+bool Optimizer::IsUsed(Symbol id, Expression* expr)
+{
+	switch (expr->GetKind())
+	{
+		case ExpressionKind::Var:
+			return static_cast<VarExpression*>(expr)->GetId() == id;
+		case ExpressionKind::Add:
+		{
+			auto add = static_cast<AddExpression*>(expr);
+			return IsUsed(id, add->GetLeftOperand()) || IsUsed(id, add->GetRightOperand());
+		}
+		case ExpressionKind::If:
+		{
+			auto ifExpr = static_cast<IfExpression*>(expr);
+			return IsUsed(id, ifExpr->GetLeftOperand()) || IsUsed(id, ifExpr->GetRightOperand())
+				|| IsUsed(id, ifExpr->GetThenBranch()) || IsUsed(id, ifExpr->GetElseBranch());
+		}
+		case ExpressionKind::Let:
+		{
+			// Одноимённая переменная перекрывает тело и значение-функцию,
+			// другие значения видят внешнюю переменную (см. Resolver)
+			auto let = static_cast<LetExpression*>(expr);
+			if (let->GetId() == id)
+				return let->GetExpression()->GetKind() != ExpressionKind::Function && IsUsed(id, let->GetExpression());
+			return IsUsed(id, let->GetExpression()) || IsUsed(id, let->GetBody());
+		}
+		case ExpressionKind::Function:
+		{
+			auto function = static_cast<FunctionExpression*>(expr);
+			if (function->GetArgument() == id) return false;
+			return IsUsed(id, function->GetBody());
+		}
+		case ExpressionKind::Call:
+		{
+			auto call = static_cast<CallExpression*>(expr);
+			return IsUsed(id, call->GetCallable()) || IsUsed(id, call->GetArgument());
+		}
+		case ExpressionKind::Set:
+		{
+			auto set = static_cast<SetExpression*>(expr);
+			return set->GetId() == id || IsUsed(id, set->GetExpression());
+		}
+		case ExpressionKind::Block:
+			for (auto nested : static_cast<BlockExpression*>(expr)->GetExpressions())
+			{
+				if (IsUsed(id, nested)) return true;
+			}
+			return false;
+		default:
+			return false;
+	}
+}
+
+// Литерал целого и определение функции только создают значение,
+// а чтение переменной не может завершиться ошибкой, так как
+// неизвестные переменные Resolver находит до оптимизации
+bool Optimizer::IsPure(Expression* expr)
+{
+	auto kind = expr->GetKind();
+	return kind == ExpressionKind::Val || kind == ExpressionKind::Var || kind == ExpressionKind::Function;
+}
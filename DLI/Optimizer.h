@@ -0,0 +1,53 @@
+#pragma once
+
+# include "AST.h"
+# include "Arena.h"
+
+// Оптимизатор AST
+// Проход после синтаксического анализа, который
+// - сворачивает <add> с константными операндами в <val>,
+// - заменяет <if> с константными операндами выбранной ветвью,
+// - удаляет <let>, переменная которого не используется, а значение
+//   вычисляется без побочных эффектов и ошибок.
+// Изменённые узлы создаются заново в арене, неизменённые поддеревья переиспользуются.
+// Оптимизатор выполняется над деревом, уже проверенным Resolver,
+// чтобы ошибки в удаляемом коде не пропадали. Удаление <let> меняет
+// лексические адреса, поэтому затем Resolver выполняется повторно
+
+// Счётчики оптимизатора
+struct OptimizerStats
+{
+	size_t foldedAdds = 0;    // Свёрнуто выражений <add>
+	size_t foldedIfs = 0;     // Заменено ветвью выражений <if>
+	size_t removedLets = 0;   // Удалено выражений <let>
+};
+
+class Optimizer
+{
+	Arena& arena;         // Арена, в которой создаются новые узлы
+	OptimizerStats stats;
+public:
+	Optimizer(Arena& arena);
+
+	// Оптимизировать выражение, вернуть корень нового дерева
+	Expression* Optimize(Expression*);
+
+	const OptimizerStats& GetStats() const;
+
+protected:
+	// Методы для оптимизации конкретных выражений
+	Expression* Optimize(AddExpression*);
+	Expression* Optimize(IfExpression*);
+	Expression* Optimize(LetExpression*);
+	Expression* Optimize(FunctionExpression*);
+	Expression* Optimize(CallExpression*);
+	Expression* Optimize(SetExpression*);
+	Expression* Optimize(BlockExpression*);
+
+	// Есть ли в выражении обращение (<var> или <set>) к переменной id,
+	// не перекрытое вложенным объявлением с тем же именем
+	static bool IsUsed(Symbol id, Expression*);
+
+	// Вычисляется ли выражение без побочных эффектов и ошибок
+	static bool IsPure(Expression*);
+};
@@ -0,0 +1,248 @@
+#include "Parallel.h"
+
+# include <algorithm>
+# include <atomic>
+# include <exception>
+# include <memory>
+# include <mutex>
+# include <thread>
+# include <vector>
+
+namespace
+{
+	// Диапазон заданий потока
+	// Владелец берёт задания с начала, другие потоки - с конца
+	class WorkRange
+	{
+		std::mutex mutex;
+		size_t begin = 0;
+		size_t end = 0;
+	public:
+		void Assign(size_t first, size_t last)
+		{
+			begin = first;
+			end = last;
+		}
+
+		bool PopFront(size_t& index)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (begin == end) return false;
+			index = begin++;
+			return true;
+		}
+
+		bool StealBack(size_t& index)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (begin == end) return false;
+			index = --end;
+			return true;
+		}
+	};
+
+	// Пул и номер рабочего потока, в котором выполняется код
+	thread_local const TaskPool* currentPool = nullptr;
+	thread_local size_t currentWorker = 0;
+}
+
+void ParallelFor(size_t count, size_t threads, const std::function<void(size_t worker, size_t index)>& body)
+{
+	threads = std::max<size_t>(1, std::min(threads, count));
+	if (threads == 1)
+	{
+		for (size_t index = 0; index < count; index++)
+		{
+			body(0, index);
+		}
+		return;
+	}
+
+	std::unique_ptr<WorkRange[]> ranges(new WorkRange[threads]);
+	for (size_t worker = 0; worker < threads; worker++)
+	{
+		ranges[worker].Assign(count * worker / threads, count * (worker + 1) / threads);
+	}
+
+	// Новые задания не появляются, поэтому поток, не нашедший
+	// заданий ни в своём, ни в чужих диапазонах, завершается
+	std::atomic<bool> failed(false);
+	std::exception_ptr error;
+	std::mutex errorMutex;
+	auto work = [&](size_t worker)
+	{
+		size_t index;
+		while (!failed.load(std::memory_order_relaxed))
+		{
+			bool found = ranges[worker].PopFront(index);
+			for (size_t i = 1; !found && i < threads; i++)
+			{
+				found = ranges[(worker + i) % threads].StealBack(index);
+			}
+			if (!found) break;
+
+			try {
+				body(worker, index);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(errorMutex);
+				if (!error) error = std::current_exception();
+				failed = true;
+			}
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (size_t worker = 1; worker < threads; worker++)
+	{
+		pool.emplace_back(work, worker);
+	}
+	work(0);
+	for (auto& thread : pool)
+	{
+		thread.join();
+	}
+
+	if (error) std::rethrow_exception(error);
+}
+
+size_t GetDefaultThreadCount()
+{
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+TaskPool::TaskPool(size_t threads)
+	: queues(new Queue[std::max<size_t>(1, threads)]), threads(std::max<size_t>(1, threads)),
+	pending(0), sleeping(0), stop(false)
+{
+	for (size_t worker = 1; worker < this->threads; worker++)
+	{
+		workers.emplace_back(&TaskPool::Work, this, worker);
+	}
+}
+
+TaskPool::~TaskPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stop = true;
+	}
+	wakeUp.notify_all();
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+size_t TaskPool::GetThreadCount() const
+{
+	return threads;
+}
+
+size_t TaskPool::GetCurrentWorker() const
+{
+	return currentPool == this ? currentWorker : 0;
+}
+
+// Спящие потоки будятся, только если они есть: добавление задания
+// в очередь обычно обходится без системных вызовов
+void TaskPool::Push(Task& task)
+{
+	auto& queue = queues[GetCurrentWorker()];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(&task);
+	}
+	pending++;
+	if (sleeping > 0)
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		wakeUp.notify_one();
+	}
+}
+
+bool TaskPool::Retract(Task& task)
+{
+	auto& queue = queues[GetCurrentWorker()];
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	if (queue.tasks.empty() || queue.tasks.back() != &task) return false;
+	queue.tasks.pop_back();
+	pending--;
+	return true;
+}
+
+void TaskPool::Wait(Task& task)
+{
+	size_t worker = GetCurrentWorker();
+	while (!task.done.load(std::memory_order_acquire))
+	{
+		Task* other = Find(worker);
+		if (other) Run(*other);
+		else std::this_thread::yield();
+	}
+	if (task.error) std::rethrow_exception(task.error);
+}
+
+TaskPool::Task* TaskPool::Find(size_t worker)
+{
+	if (pending == 0) return nullptr;
+	{
+		auto& queue = queues[worker];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.tasks.empty())
+		{
+			Task* task = queue.tasks.back();
+			queue.tasks.pop_back();
+			pending--;
+			return task;
+		}
+	}
+	for (size_t i = 1; i < threads; i++)
+	{
+		auto& queue = queues[(worker + i) % threads];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.tasks.empty())
+		{
+			Task* task = queue.tasks.front();
+			queue.tasks.pop_front();
+			pending--;
+			return task;
+		}
+	}
+	return nullptr;
+}
+
+void TaskPool::Run(Task& task)
+{
+	try {
+		task.body();
+	}
+	catch (...)
+	{
+		task.error = std::current_exception();
+	}
+	task.done.store(true, std::memory_order_release);
+}
+
+// Рабочий поток засыпает, когда заданий в очередях нет
+void TaskPool::Work(size_t worker)
+{
+	currentPool = this;
+	currentWorker = worker;
+	while (true)
+	{
+		Task* task = Find(worker);
+		if (task)
+		{
+			Run(*task);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleeping++;
+		wakeUp.wait(lock, [this]() { return stop || pending > 0; });
+		sleeping--;
+		if (stop) return;
+	}
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+# include <atomic>
+# include <condition_variable>
+# include <cstddef>
+# include <deque>
+# include <exception>
+# include <functional>
+# include <memory>
+# include <mutex>
+# include <thread>
+# include <vector>
+
+// Параллельное выполнение независимых заданий
+
+// Выполнить body(worker, index) для каждого index из [0, count) на threads потоках
+// worker - номер потока от 0 до threads - 1, нулевым потоком работает вызывающий.
+// Задания делятся между потоками непрерывными диапазонами, каждый поток берёт
+// задания из начала своего диапазона, а закончив свои, забирает задания из конца
+// диапазонов других потоков (work stealing), так что долгие задания
+// не оставляют остальные потоки без работы.
+// Если body выбросило исключение, оставшиеся задания не начинаются,
+// а первое исключение выбрасывается после завершения всех потоков
+void ParallelFor(size_t count, size_t threads, const std::function<void(size_t worker, size_t index)>& body);
+
+// Число потоков по умолчанию - число ядер процессора
+size_t GetDefaultThreadCount();
+
+// Пул потоков для вложенного параллелизма вида fork-join
+// Задание добавляется в очередь потока, который его создал, а затем
+// этот поток либо забирает его обратно, если задание никто не начал,
+// либо дожидается его завершения. Свободные потоки берут задания
+// из начала чужих очередей (work stealing), а владелец - из конца своей,
+// так что первыми раздаются самые старые, обычно самые крупные задания.
+// Ожидающий поток не простаивает, а выполняет другие задания.
+// Потоком 0 считается любой поток вне пула, поэтому пул предназначен
+// для одного внешнего потока
+class TaskPool
+{
+public:
+	// Задание пула
+	// Живёт у создавшего его кода и должно пережить его выполнение
+	class Task
+	{
+		std::function<void()> body;
+		std::atomic<bool> done;
+		std::exception_ptr error;   // Исключение, выброшенное заданием
+		friend class TaskPool;
+	public:
+		explicit Task(std::function<void()> body) : body(std::move(body)), done(false) {}
+	};
+
+	// Пул из threads потоков: threads - 1 рабочих и поток, создавший пул
+	explicit TaskPool(size_t threads);
+	TaskPool(const TaskPool&) = delete;
+	TaskPool& operator=(const TaskPool&) = delete;
+	~TaskPool();
+
+	size_t GetThreadCount() const;
+
+	// Добавить задание в очередь текущего потока
+	void Push(Task&);
+
+	// Забрать задание обратно, если его ещё не начали выполнять
+	// Задание должно быть последним из добавленных текущим потоком и ещё не снятых
+	bool Retract(Task&);
+
+	// Дождаться завершения задания, выполняя тем временем другие задания
+	// Исключение задания выбрасывается в ожидающем потоке
+	void Wait(Task&);
+
+protected:
+	// Очередь заданий потока
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<Task*> tasks;
+	};
+
+	size_t GetCurrentWorker() const;
+	Task* Find(size_t worker);  // Взять задание из своей очереди или чужих
+	void Run(Task&);
+	void Work(size_t worker);   // Цикл рабочего потока
+
+private:
+	std::unique_ptr<Queue[]> queues;
+	size_t threads;
+	std::vector<std::thread> workers;
+	std::atomic<size_t> pending;  // Заданий в очередях
+	std::atomic<size_t> sleeping; // Рабочих потоков, ждущих заданий
+	std::atomic<bool> stop;
+	std::mutex sleepMutex;
+	std::condition_variable wakeUp;
+};
@@ -0,0 +1,137 @@
+#include "ParallelLexer.h"
+
+# include "Parallel.h"
+# include <algorithm>
+# include "CharScanner.h"
+
+namespace
+{
+	// Граница части: первый пробельный символ, начиная с position
+	const char* FindBoundary(const char* position, const char* end)
+	{
+		while (position < end && !IsSpace((unsigned char)*position)) position++;
+		return position;
+	}
+}
+
+ParallelLexer::ParallelLexer(SymbolTable& symbols, const char* begin, const char* end, size_t threads)
+{
+	// Делим текст на части примерно равного размера
+	size_t size = end - begin;
+	size_t count = std::max<size_t>(1, std::min(threads, size / MIN_CHUNK_SIZE));
+	const char* chunkBegin = begin;
+	for (size_t i = 1; i <= count && chunkBegin < end; i++)
+	{
+		const char* chunkEnd = i == count ? end : FindBoundary(std::max(chunkBegin, begin + size * i / count), end);
+		if (chunkEnd == chunkBegin) continue;
+		chunks.emplace_back();
+		chunks.back().begin = chunkBegin;
+		chunks.back().end = chunkEnd;
+		chunkBegin = chunkEnd;
+	}
+
+	// Переводы строк в каждой части считаются параллельно,
+	// затем из них получаются позиции начала частей
+	std::vector<size_t> rows(chunks.size());
+	std::vector<const char*> lastLines(chunks.size());
+	ParallelFor(chunks.size(), threads, [&](size_t, size_t i)
+	{
+		auto& part = chunks[i];
+		rows[i] = std::count(part.begin, part.end, '\n');
+		lastLines[i] = part.begin;
+		for (const char* ch = part.end; ch > part.begin; ch--)
+		{
+			if (ch[-1] == '\n')
+			{
+				lastLines[i] = ch;
+				break;
+			}
+		}
+	});
+	PositionInText position(1, 0);
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		chunks[i].start = position;
+		if (rows[i] == 0)
+		{
+			position.col += (unsigned int)(chunks[i].end - chunks[i].begin);
+		}
+		else
+		{
+			position.row += (unsigned int)rows[i];
+			position.col = (unsigned int)(chunks[i].end - lastLines[i]);
+		}
+	}
+
+	// Чтение частей
+	ParallelFor(chunks.size(), threads, [&](size_t, size_t i)
+	{
+		auto& part = chunks[i];
+		BufferLexer lexer(symbols, part.begin, part.end, part.start);
+		// Лексема занимает в среднем несколько символов
+		part.lexemes.reserve((part.end - part.begin) / 3);
+		try {
+			Lexeme lexeme;
+			while (lexer.Scan(lexeme))
+			{
+				part.lexemes.push_back(lexeme);
+			}
+		}
+		catch (...)
+		{
+			part.error = std::current_exception();
+		}
+	});
+}
+
+ParallelLexer::~ParallelLexer()
+{
+	Destroy(token);
+	Destroy(lookahead);
+}
+
+Token* ParallelLexer::Next()
+{
+	Destroy(token);
+	if (lookahead)
+		std::swap(token, lookahead);
+	else
+		token = Scan(nullptr);
+	return token;
+}
+
+Token* ParallelLexer::Peek()
+{
+	if (!lookahead)
+		lookahead = Scan(token);
+	return lookahead;
+}
+
+void ParallelLexer::Destroy(Token*& token)
+{
+	if (token) token->~Token();
+	token = nullptr;
+}
+
+size_t ParallelLexer::GetChunkCount() const
+{
+	return chunks.size();
+}
+
+// Лексемы выдаются по порядку частей
+// В конце части, чтение которой прервала ошибка, выбрасывается эта ошибка
+Token* ParallelLexer::Scan(const Token* busy)
+{
+	auto& free = busy == (Token*)&storage[0] ? storage[1] : storage[0];
+	while (chunk < chunks.size())
+	{
+		auto& part = chunks[chunk];
+		if (index < part.lexemes.size())
+			return BufferLexer::CreateToken(part.lexemes[index++], free);
+		if (part.error)
+			std::rethrow_exception(part.error);
+		chunk++;
+		index = 0;
+	}
+	return nullptr;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+# include "BufferLexer.h"
+# include "SymbolTable.h"
+# include "Token.h"
+# include "TokenStream.h"
+# include <cstddef>
+# include <exception>
+# include <memory>
+# include <vector>
+
+// Лексический анализатор большого текста в памяти, работающий на нескольких потоках
+// В языке нет строк и комментариев, поэтому любой пробельный символ - граница
+// лексем: текст делится на части по пробельным символам, части читаются
+// параллельно, каждая своим BufferLexer, а лексемы затем выдаются по порядку.
+// Позиция начала каждой части вычисляется заранее, параллельным подсчётом
+// переводов строки, поэтому позиции лексем совпадают с позициями BufferLexer.
+// Ошибка в части текста выбрасывается, когда до неё доходит чтение лексем,
+// так что ошибки разбора в предыдущем тексте обнаруживаются раньше, как и у BufferLexer
+class ParallelLexer : public TokenStream
+{
+	// Меньшие части не делятся: на них запуск потока дороже чтения
+	static const size_t MIN_CHUNK_SIZE = 64 * 1024;
+
+	// Прочитанная часть текста
+	struct Chunk
+	{
+		const char* begin = nullptr;
+		const char* end = nullptr;
+		PositionInText start;          // Позиция последнего символа перед частью
+		std::vector<Lexeme> lexemes;   // Лексемы части
+		std::exception_ptr error;      // Ошибка, на которой чтение части остановилось
+	};
+
+	std::vector<Chunk> chunks;
+	size_t chunk = 0;                  // Часть, из которой выдаются лексемы
+	size_t index = 0;                  // Номер следующей лексемы в ней
+
+	// Одновременно существуют не больше двух лексем: выданная и просмотренная
+	// вперёд, поэтому они создаются по очереди в двух областях памяти,
+	// без обращения к куче для каждой лексемы
+	TokenStorage storage[2];
+	Token* token = nullptr;            // Последняя выданная лексема
+	Token* lookahead = nullptr;        // Просмотренная вперёд лексема
+public:
+	// Прочитать текст [begin, end) на threads потоках
+	ParallelLexer(SymbolTable& symbols, const char* begin, const char* end, size_t threads);
+	ParallelLexer(const ParallelLexer&) = delete;
+	ParallelLexer& operator=(const ParallelLexer&) = delete;
+	~ParallelLexer();
+
+	// Прочитать следующую лексему
+	virtual Token* Next();
+
+	// Посмотреть следующую лексему, не читая её
+	virtual Token* Peek();
+
+	// На сколько частей разделён текст
+	size_t GetChunkCount() const;
+protected:
+	// Создать следующую прочитанную лексему в области памяти, не занятой лексемой busy
+	Token* Scan(const Token* busy);
+	void Destroy(Token*&);  // Уничтожить лексему
+};
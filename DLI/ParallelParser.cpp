@@ -0,0 +1,191 @@
+#include "ParallelParser.h"
+
+# include "BufferLexer.h"
+# include "CharScanner.h"
+# include "Keywords.h"
+# include "Parallel.h"
+# include <algorithm>
+# include <exception>
+# include <string_view>
+# include <vector>
+
+namespace
+{
+	// Разбираемая на одном потоке группа вложенных выражений блока
+	struct Group
+	{
+		const char* begin = nullptr;
+		const char* end = nullptr;
+		PositionInText start;               // Позиция последнего символа перед группой
+		Arena arena;                        // Узлы выражений группы
+		std::vector<Expression*> items;     // Разобранные выражения
+		ParserStats stats;
+		std::exception_ptr error;           // Ошибка, на которой разбор группы остановился
+	};
+
+	const char* SkipSpaces(const char* position, const char* end)
+	{
+		while (position < end && IsSpace((unsigned char)*position)) position++;
+		return position;
+	}
+
+	const char* SkipWord(const char* position, const char* end)
+	{
+		while (position < end && IsAlnum((unsigned char)*position)) position++;
+		return position;
+	}
+}
+
+ParallelParser::ParallelParser(SymbolTable& symbols, Arena& arena, size_t threads)
+	: symbols(symbols), arena(arena), threads(threads)
+{
+}
+
+const ParserStats& ParallelParser::GetStats() const
+{
+	return stats;
+}
+
+size_t ParallelParser::GetGroupCount() const
+{
+	return groupCount;
+}
+
+Expression* ParallelParser::ParseSequentially(const char* begin, const char* end)
+{
+	BufferLexer lexer(symbols, begin, end);
+	Parser parser(lexer, arena);
+	auto expr = parser.Parse();
+	stats = parser.GetStats();
+	return expr;
+}
+
+Expression* ParallelParser::Parse(const char* begin, const char* end)
+{
+	groupCount = 0;
+	stats = ParserStats();
+
+	// Программа должна начинаться с "(block"
+	const char* open = SkipSpaces(begin, end);
+	if (open == end || *open != '(') return ParseSequentially(begin, end);
+	const char* keyword = SkipSpaces(open + 1, end);
+	const char* first = SkipWord(keyword, end);
+	if (FindKeyword(std::string_view(keyword, first - keyword)) != Keyword::Block)
+		return ParseSequentially(begin, end);
+
+	// Начала вложенных выражений - открывающие скобки на глубине 1,
+	// блок заканчивается скобкой, возвращающей глубину к нулю
+	std::vector<const char*> items;
+	size_t depth = 1;
+	const char* close = first;
+	for (; close < end; close++)
+	{
+		if (*close == '(')
+		{
+			if (depth == 1) items.push_back(close);
+			depth++;
+		}
+		else if (*close == ')' && --depth == 0)
+		{
+			break;
+		}
+	}
+	if (close == end || items.empty()) return ParseSequentially(begin, end);
+
+	// Группы начинаются с вложенного выражения, ближайшего к границе равных частей
+	// Групп больше, чем потоков, чтобы потоки, закончившие раньше, забирали оставшиеся
+	size_t size = close - first;
+	size_t count = std::min(threads * 4, size / MIN_GROUP_SIZE);
+	std::vector<const char*> bounds = { first };
+	for (size_t i = 1; i < count; i++)
+	{
+		auto item = std::lower_bound(items.begin(), items.end(), first + size * i / count);
+		if (item != items.end() && *item > bounds.back()) bounds.push_back(*item);
+	}
+	if (bounds.size() < 2) return ParseSequentially(begin, end);
+
+	// Позиции начала групп: переводы строк в тексте перед каждой группой
+	// считаются параллельно, затем из них получаются позиции
+	std::vector<Group> groups(bounds.size());
+	std::vector<size_t> rows(bounds.size());
+	std::vector<const char*> lastLines(bounds.size());
+	ParallelFor(bounds.size(), threads, [&](size_t, size_t i)
+	{
+		const char* from = i == 0 ? begin : bounds[i - 1];
+		rows[i] = std::count(from, bounds[i], '\n');
+		lastLines[i] = from;
+		for (const char* ch = bounds[i]; ch > from; ch--)
+		{
+			if (ch[-1] == '\n')
+			{
+				lastLines[i] = ch;
+				break;
+			}
+		}
+	});
+	PositionInText position(1, 0);
+	for (size_t i = 0; i < groups.size(); i++)
+	{
+		const char* from = i == 0 ? begin : bounds[i - 1];
+		if (rows[i] == 0)
+		{
+			position.col += (unsigned int)(bounds[i] - from);
+		}
+		else
+		{
+			position.row += (unsigned int)rows[i];
+			position.col = (unsigned int)(bounds[i] - lastLines[i]);
+		}
+		groups[i].begin = bounds[i];
+		groups[i].end = i + 1 < bounds.size() ? bounds[i + 1] : close;
+		groups[i].start = position;
+	}
+
+	// Позиция блока - позиция его открывающей скобки
+	const char* lineStart = begin;
+	for (const char* ch = begin; ch < open; ch++)
+	{
+		if (*ch == '\n') lineStart = ch + 1;
+	}
+	PositionInText blockPosition((unsigned int)(1 + std::count(begin, open, '\n')), (unsigned int)(open - lineStart + 1));
+
+	// Разбор групп
+	ParallelFor(groups.size(), threads, [&](size_t, size_t i)
+	{
+		auto& group = groups[i];
+		BufferLexer lexer(symbols, group.begin, group.end, group.start);
+		Parser parser(lexer, group.arena);
+		try {
+			parser.ParseSequence(group.items);
+		}
+		catch (...)
+		{
+			group.error = std::current_exception();
+		}
+		group.stats = parser.GetStats();
+	});
+
+	// Сборка блока в общей арене
+	size_t total = 0;
+	for (auto& group : groups)
+	{
+		if (group.error) std::rethrow_exception(group.error);
+		total += group.items.size();
+	}
+
+	// Лексемы "(", "block" и ")" и узел самого блока
+	stats.tokens = 3;
+	stats.nodes = 1;
+	auto blockItems = arena.CreateArray<Expression>(total);
+	size_t index = 0;
+	for (auto& group : groups)
+	{
+		arena.Merge(group.arena);
+		std::copy(group.items.begin(), group.items.end(), blockItems + index);
+		index += group.items.size();
+		stats.tokens += group.stats.tokens;
+		stats.nodes += group.stats.nodes;
+	}
+	groupCount = groups.size();
+	return arena.Create<BlockExpression>(ExpressionList(blockItems, total), blockPosition);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+# include "Parser.h"
+# include "SymbolTable.h"
+# include "Arena.h"
+# include "AST.h"
+# include <cstddef>
+
+// Синтаксический анализатор большого текста в памяти, работающий на нескольких потоках
+// Большая программа обычно - один внешний (block ...) из множества независимых
+// выражений. Скобки в языке - отдельные лексемы, а строк и комментариев нет,
+// поэтому границы вложенных выражений блока находятся подсчётом глубины скобок
+// без лексического анализа. Вложенные выражения делятся на группы, каждая группа
+// разбирается своими BufferLexer и Parser в собственной арене, а затем арены
+// групп передаются в общую и узлы собираются в блок.
+// AST, счётчики и ошибки совпадают с последовательным разбором: группа
+// начинается с позиции в тексте, вычисленной заранее, а из ошибок групп
+// выбрасывается первая по тексту. Программа другого вида, а также
+// небольшая или с несбалансированными скобками, разбирается последовательно
+class ParallelParser
+{
+	// Меньшие группы не выделяются: на них запуск потока дороже разбора
+	static const size_t MIN_GROUP_SIZE = 64 * 1024;
+
+	SymbolTable& symbols;
+	Arena& arena;                      // Арена, в которую попадают узлы AST
+	size_t threads;
+	size_t groupCount = 0;             // На сколько групп разделён последний блок
+	ParserStats stats;
+public:
+	ParallelParser(SymbolTable& symbols, Arena& arena, size_t threads);
+
+	// Разобрать программу [begin, end)
+	Expression* Parse(const char* begin, const char* end);
+
+	const ParserStats& GetStats() const;
+
+	// На сколько групп были разделены вложенные выражения,
+	// 0 - программа разобрана последовательно
+	size_t GetGroupCount() const;
+protected:
+	Expression* ParseSequentially(const char* begin, const char* end);
+};
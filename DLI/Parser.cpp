@@ -1,8 +1,9 @@
 #include "Parser.h"
+#include <algorithm>
 
 // Получть следующую лексему - определенное ключевое слово
 // Если она не является таковой, то ошибка
-KeywordToken* Parser::GetKeyword(const std::string &str)
+KeywordToken* Parser::GetKeyword(Keyword keyword)
 {
 	KeywordToken* token;
 	try {
@@ -10,33 +11,38 @@ KeywordToken* Parser::GetKeyword(const std::string &str)
 	}
 	catch (UnexpectedTokenException &err)
 	{
-		throw UnexpectedTokenWithExpectedKeywordException(err.GetToken(), str, err.GetPosition());
+		throw UnexpectedTokenWithExpectedKeywordException(err.GetToken(), keyword, err.GetPosition());
 	}
-	if (token->GetKeyword() != str) 
-		throw UnexpectedTokenWithExpectedKeywordException(token, str, token->GetPosition());
+	if (token->GetKeyword() != keyword) 
+		throw UnexpectedTokenWithExpectedKeywordException(token, keyword, token->GetPosition());
 	return token;
 }
 
 // Получить следующую лексему
 Token* Parser::NextToken()
 {
-	if (it != end)
+	auto token = tokens.Next();
+	if (token)
 	{
-		auto token = *it;
-		it++;
+		stats.tokens++;
+		lastTokenPosition = token->GetPosition();
 		return token;
 	}
-	auto lastToken = *(--it);
-	auto lastTokenPosition = lastToken->GetPosition();
+	throw UnexpectedEndOfFileException(PositionInText(lastTokenPosition.row + 1, 0));
+}
+
+// Посмотреть следующую лексему
+Token* Parser::PeekToken()
+{
+	auto token = tokens.Peek();
+	if (token) return token;
 	throw UnexpectedEndOfFileException(PositionInText(lastTokenPosition.row + 1, 0));
 }
 
 // Создать синтаксический анализатор
-// tokens - последовательность лексем
-Parser::Parser(std::list<Token*>& tokens)
+// tokens - поток лексем
+Parser::Parser(TokenStream& tokens, Arena& arena) : tokens(tokens), arena(arena)
 {
-	it = tokens.begin();
-	end = tokens.end();
 }
 
 // Выполнить синтаксический разбор
@@ -45,6 +51,20 @@ Expression* Parser::Parse()
 	return ParseExpression();
 }
 
+// Так разбирается часть вложенных выражений блока
+void Parser::ParseSequence(std::vector<Expression*>& expressions)
+{
+	while (tokens.Peek())
+	{
+		expressions.push_back(ParseExpression());
+	}
+}
+
+const ParserStats& Parser::GetStats() const
+{
+	return stats;
+}
+
 // Базовый метод рекурсивного спуска
 // Читаем произвольное выражение
 Expression* Parser::ParseExpression()
@@ -56,39 +76,42 @@ Expression* Parser::ParseExpression()
 	// Затем ключевое слово
 	auto keyword = GetToken<KeywordToken>();
 	Expression* expression = nullptr;
-
-	const std::string& str = keyword->GetKeyword();
+	stats.nodes++;
 
 	// По значению ключевого слова определяем тип выражения
 	// и вызываем для его разбора соответствующий метод
-	if (str == "block")
-	{
-		expression = (Expression*) ParseBlockExpression();
-	} 
-	else if (str == "val") 
+	switch (keyword->GetKeyword())
 	{
-		expression = (Expression*) ParseValExpression();
-	}
-	else if (str == "let") {
-		expression = (Expression*) ParseLetExpression();
-	}
-	else if (str == "var") {
-		expression = (Expression*)ParseVarExpression();
-	}
-	else if (str == "add") {
-		expression = (Expression*)ParseAddExpression();
-	}
-	else if (str == "if") {
-		expression = (Expression*)ParseIfxpression();
-	}
-	else if (str == "function") {
-		expression = (Expression*)ParseFunctionExpression();
-	}
-	else if (str == "call") {
-		expression = (Expression*)ParseCallExpression();
-	}
-	else if (str == "set") {
-		expression = (Expression*)ParseSetExpression();
+		case Keyword::Block:
+			expression = (Expression*) ParseBlockExpression();
+			break;
+		case Keyword::Val:
+			expression = (Expression*) ParseValExpression();
+			break;
+		case Keyword::Let:
+			expression = (Expression*) ParseLetExpression();
+			break;
+		case Keyword::Var:
+			expression = (Expression*) ParseVarExpression();
+			break;
+		case Keyword::Add:
+			expression = (Expression*) ParseAddExpression();
+			break;
+		case Keyword::If:
+			expression = (Expression*) ParseIfxpression();
+			break;
+		case Keyword::Function:
+			expression = (Expression*) ParseFunctionExpression();
+			break;
+		case Keyword::Call:
+			expression = (Expression*) ParseCallExpression();
+			break;
+		case Keyword::Set:
+			expression = (Expression*) ParseSetExpression();
+			break;
+		default:
+			// then, else и in не начинают выражений
+			throw UnexpectedKeywordException(keyword->GetKeyword(), keyword->GetPosition());
 	}
 
 	// Читаем закрывающуюся скобку
@@ -107,59 +130,61 @@ ValExpression* Parser::ParseValExpression()
 {
 	auto valueToken = GetToken<ValueToken>();
 	int value = valueToken->GetValue();
-	return new ValExpression(value, GetExpressionPosition());
+	return arena.Create<ValExpression>(value, GetExpressionPosition());
 }
 
 // Читаем выражение (block <expression>+)
+// Вложенные выражения накапливаются в общем для всех блоков стэке blockItems,
+// и по окончании блока переносятся в массив в арене
 BlockExpression* Parser::ParseBlockExpression()
 {
-	BlockExpression * expr = new BlockExpression(GetExpressionPosition());
+	size_t first = blockItems.size();
 
 	// Заглядываем на лексему вперёд
 	do {
-		auto token = NextToken();
+		auto token = PeekToken();
 		// Пока не найдём закрывающуюся скобку
-		auto closeBracket = dynamic_cast<CloseBracketToken*>(token);
-		
-		it--;
-		
 		// Если нашли
-		if (closeBracket) {
+		if (token->GetType() == TokenType::CloseBracket) {
 			break; // То заканчиваем чтение выражения
 		} else {
 			// Если нет, читаем вложенные выражения
 			Expression* nestedExpression = ParseExpression();
-			expr->AddExpression(nestedExpression);
+			blockItems.push_back(nestedExpression);
 		}
 
 	} while (true);
 
+	size_t count = blockItems.size() - first;
+
 	// Блок выражения не может быть пустым
-	if (expr->GetExpressions().size() == 0)
+	if (count == 0)
 	{
-		delete expr;
 		throw EmptyBlockException(GetExpressionPosition());
 	}
 
-	return expr;
+	auto items = arena.CreateArray<Expression>(count);
+	std::copy(blockItems.begin() + first, blockItems.end(), items);
+	blockItems.resize(first);
+	return arena.Create<BlockExpression>(ExpressionList(items, count), GetExpressionPosition());
 }
 
 // Читаем выражение (let <id> = <expression> in <expression>)
 LetExpression* Parser::ParseLetExpression()
 {
-	auto id = GetToken<IdentifierToken>();
+	auto id = GetToken<IdentifierToken>()->GetId();
 	static_cast<void>(GetToken<AssignOperatorToken>());
 	auto expression = ParseExpression();
-	static_cast<void>(GetKeyword("in"));
+	static_cast<void>(GetKeyword(Keyword::In));
 	auto body = ParseExpression();
-	return new LetExpression(id->GetId(), expression, body, GetExpressionPosition());
+	return arena.Create<LetExpression>(id, expression, body, GetExpressionPosition());
 }
 
 // Читаем выражение (var <id>)
 VarExpression* Parser::ParseVarExpression()
 {
 	auto token = GetToken<IdentifierToken>();
-	return new VarExpression(token->GetId(), GetExpressionPosition());
+	return arena.Create<VarExpression>(token->GetId(), GetExpressionPosition());
 }
 
 // Читаем выражение (add <expression> <expression>)
@@ -167,7 +192,7 @@ AddExpression* Parser::ParseAddExpression()
 {
 	auto left = ParseExpression();
 	auto right = ParseExpression();
-	return new AddExpression(left, right, GetExpressionPosition());
+	return arena.Create<AddExpression>(left, right, GetExpressionPosition());
 }
 
 // Читаем выражение (if <expression> <expression> then <expression> else <expression>)
@@ -175,19 +200,19 @@ IfExpression* Parser::ParseIfxpression()
 {
 	auto left = ParseExpression();
 	auto right = ParseExpression();
-	static_cast<void>(GetKeyword("then"));
+	static_cast<void>(GetKeyword(Keyword::Then));
 	auto trueBranch = ParseExpression();
-	static_cast<void>(GetKeyword("else"));
+	static_cast<void>(GetKeyword(Keyword::Else));
 	auto elseBranch = ParseExpression();
-	return new IfExpression(left, right, trueBranch, elseBranch, GetExpressionPosition());
+	return arena.Create<IfExpression>(left, right, trueBranch, elseBranch, GetExpressionPosition());
 }
 
 // Читаем выражение (function <id> <expression>)
 FunctionExpression* Parser::ParseFunctionExpression()
 {
-	auto id = GetToken<IdentifierToken>();
+	auto id = GetToken<IdentifierToken>()->GetId();
 	auto body = ParseExpression();
-	return new FunctionExpression(id->GetId(), body, GetExpressionPosition());
+	return arena.Create<FunctionExpression>(id, body, GetExpressionPosition());
 }
 
 // Читаем выражение (call <expression> <expression>)
@@ -195,13 +220,13 @@ CallExpression* Parser::ParseCallExpression()
 {
 	auto function = ParseExpression();
 	auto argument = ParseExpression();
-	return new CallExpression(function, argument, GetExpressionPosition());
+	return arena.Create<CallExpression>(function, argument, GetExpressionPosition());
 }
 
 // Читаем выражение (set <id> <expression>)
 SetExpression* Parser::ParseSetExpression()
 {
-	auto id = GetToken<IdentifierToken>();
+	auto id = GetToken<IdentifierToken>()->GetId();
 	auto val = ParseExpression();
-	return new SetExpression(id->GetId(), val, GetExpressionPosition());
+	return arena.Create<SetExpression>(id, val, GetExpressionPosition());
 }
\ No newline at end of file
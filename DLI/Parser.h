@@ -1,23 +1,31 @@
 #pragma once
 
 # include "Token.h"
+# include "TokenStream.h"
 # include "AST.h"
 # include "Exceptions.h"
 # include <string>
 # include <vector>
 # include <stack>
-# include <list>
 # include <exception>
-#include <memory>
+
+// Счётчики синтаксического анализатора
+struct ParserStats
+{
+	size_t tokens = 0; // Прочитано лексем
+	size_t nodes = 0;  // Построено узлов AST
+};
 
 // Синтаксический анализатор
 // Строит AST по последовательности лексем
 class Parser
 {
-	std::list<Token*> tokens;           // Исходные лексемы
-	std::list<Token*>::iterator it;     // Итератор текущей лексемы
-	std::list<Token*>::iterator end;    // Конец списка лексем
+	TokenStream& tokens;                // Поток исходных лексем
+	PositionInText lastTokenPosition;   // Позиция последней прочитанной лексемы
 	std::stack<PositionInText> positionInText; // Стэк позиций в тексте
+	Arena& arena;                       // Арена, в которой размещаются узлы AST
+	std::vector<Expression*> blockItems; // Вложенные выражения разбираемых блоков
+	ParserStats stats;
 protected:
 	// Попытка получить следующую лексему типа T
 	// Если лексема отсутствует, или имеет тип отличный от T, то будет выбрашено исключение
@@ -26,12 +34,16 @@ protected:
 	// Попытка получить следующую лексему соответствующую ключевому слову keyword
 	// Если лексема отсутствует, имеет тип отличный от KeywordToken или значение отличное от keyword,
 	// Будет выбрашено исключение
-	KeywordToken* GetKeyword(const std::string& keyword);
+	KeywordToken* GetKeyword(Keyword keyword);
 
 	// Попытка получить следующую лексему
 	// Если лексема отсутствует - будет выбрашено исключение
 	Token* NextToken();
 
+	// Посмотреть следующую лексему, не читая её
+	// Если лексема отсутствует - будет выбрашено исключение
+	Token* PeekToken();
+
 	// Методы разбора синтаксических конструкций языка
 	ValExpression* ParseValExpression();
 	BlockExpression* ParseBlockExpression();
@@ -47,15 +59,21 @@ protected:
 
 	const PositionInText& GetExpressionPosition() const;
 public:
-	Parser(std::list<Token*>& tokens);
+	Parser(TokenStream& tokens, Arena& arena);
 	Expression* Parse();
+
+	// Разобрать выражения, идущие подряд до конца потока лексем,
+	// и добавить их в expressions
+	void ParseSequence(std::vector<Expression*>& expressions);
+
+	const ParserStats& GetStats() const;
 };
 
 // Попытка получить следующую лексему типа T
+// Тип лексемы проверяется по её тегу TokenType
 template<class T> inline T* Parser::GetToken()
 {
 	auto token = NextToken();
-	T* t = dynamic_cast<T*>(token);
-	if (t) return t;
-	throw UnexpectedTokenException(token, typeid(T), token->GetPosition());
+	if (token->GetType() == T::Type) return static_cast<T*>(token);
+	throw UnexpectedTokenException(token, T::Type, token->GetPosition());
 }
@@ -0,0 +1,192 @@
+#include "Profiler.h"
+
+# include <algorithm>
+# include <iomanip>
+
+namespace
+{
+	// Имя вершины стэка, не относящейся ни к одной функции
+	const char* TOP_LEVEL = "<program>";
+}
+
+Profiler::Profiler(size_t period) : period(std::max<size_t>(period, 1))
+{
+	countdown = NextInterval();
+}
+
+// Генератор xorshift
+size_t Profiler::NextInterval()
+{
+	random ^= random << 13;
+	random ^= random >> 17;
+	random ^= random << 5;
+	return period / 2 + random % period + 1;
+}
+
+void Profiler::Prepare(Expression* program)
+{
+	Name(program);
+}
+
+void Profiler::Call(FunctionExpression* function, size_t depth)
+{
+	if (!stack.empty() && stack.back().depth == depth)
+		stack.back().function = function;
+	else
+		stack.push_back({ function, depth });
+}
+
+void Profiler::Return(size_t depth)
+{
+	while (!stack.empty() && stack.back().depth >= depth)
+	{
+		stack.pop_back();
+	}
+}
+
+// Отсчёт засчитывается выражению, функции на вершине стэка,
+// всем функциям на стэке (рекурсивная функция - один раз) и стэку целиком
+void Profiler::Sample(Expression* expr)
+{
+	samples++;
+	lines[expr->GetPosition().row]++;
+
+	std::vector<FunctionExpression*> callers;
+	callers.reserve(stack.size());
+	for (auto& frame : stack)
+	{
+		callers.push_back(frame.function);
+	}
+	stacks[callers]++;
+
+	if (stack.empty()) return;
+	functions[stack.back().function].self++;
+	std::sort(callers.begin(), callers.end());
+	callers.erase(std::unique(callers.begin(), callers.end()), callers.end());
+	for (auto function : callers)
+	{
+		functions[function].total++;
+	}
+}
+
+void Profiler::Name(Expression* expr)
+{
+	switch (expr->GetKind())
+	{
+		case ExpressionKind::Add:
+		{
+			auto add = static_cast<AddExpression*>(expr);
+			Name(add->GetLeftOperand());
+			Name(add->GetRightOperand());
+			break;
+		}
+		case ExpressionKind::If:
+		{
+			auto ifExpr = static_cast<IfExpression*>(expr);
+			Name(ifExpr->GetLeftOperand());
+			Name(ifExpr->GetRightOperand());
+			Name(ifExpr->GetThenBranch());
+			Name(ifExpr->GetElseBranch());
+			break;
+		}
+		case ExpressionKind::Let:
+		{
+			auto let = static_cast<LetExpression*>(expr);
+			if (let->GetExpression()->GetKind() == ExpressionKind::Function)
+				names.emplace(static_cast<FunctionExpression*>(let->GetExpression()), let->GetId().GetName());
+			Name(let->GetExpression());
+			Name(let->GetBody());
+			break;
+		}
+		case ExpressionKind::Function:
+		{
+			auto function = static_cast<FunctionExpression*>(expr);
+			names.emplace(function, "function " + function->GetArgument().GetName());
+			Name(function->GetBody());
+			break;
+		}
+		case ExpressionKind::Call:
+		{
+			auto call = static_cast<CallExpression*>(expr);
+			Name(call->GetCallable());
+			Name(call->GetArgument());
+			break;
+		}
+		case ExpressionKind::Set:
+		{
+			auto set = static_cast<SetExpression*>(expr);
+			if (set->GetExpression()->GetKind() == ExpressionKind::Function)
+				names.emplace(static_cast<FunctionExpression*>(set->GetExpression()), set->GetId().GetName());
+			Name(set->GetExpression());
+			break;
+		}
+		case ExpressionKind::Block:
+			for (auto nested : static_cast<BlockExpression*>(expr)->GetExpressions())
+			{
+				Name(nested);
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+std::string Profiler::GetName(FunctionExpression* function) const
+{
+	auto name = names.find(function);
+	if (name != names.end()) return name->second + function->GetPosition().ToString();
+	return "function " + function->GetArgument().GetName() + function->GetPosition().ToString();
+}
+
+void Profiler::Report(std::ostream& out, size_t limit) const
+{
+	auto flags = out.flags();
+	auto precision = out.precision();
+	auto percent = [&](size_t count) { return samples ? 100.0 * count / samples : 0.0; };
+
+	out << "Profile: " << samples << " samples, one per " << period << " steps" << std::endl;
+
+	std::vector<std::pair<FunctionExpression*, FunctionSamples>> hotFunctions(functions.begin(), functions.end());
+	std::sort(hotFunctions.begin(), hotFunctions.end(), [](const auto& a, const auto& b)
+	{
+		return a.second.self != b.second.self ? a.second.self > b.second.self : a.second.total > b.second.total;
+	});
+	if (hotFunctions.size() > limit) hotFunctions.resize(limit);
+
+	out << "Functions (self, total):" << std::endl << std::fixed << std::setprecision(1);
+	for (auto& function : hotFunctions)
+	{
+		out << std::setw(8) << percent(function.second.self) << "%"
+			<< std::setw(8) << percent(function.second.total) << "%  "
+			<< GetName(function.first) << std::endl;
+	}
+
+	std::vector<std::pair<unsigned int, size_t>> hotLines(lines.begin(), lines.end());
+	std::stable_sort(hotLines.begin(), hotLines.end(), [](const auto& a, const auto& b)
+	{
+		return a.second > b.second;
+	});
+	if (hotLines.size() > limit) hotLines.resize(limit);
+
+	out << "Lines:" << std::endl;
+	for (auto& line : hotLines)
+	{
+		out << std::setw(8) << percent(line.second) << "%  line " << line.first << std::endl;
+	}
+
+	out.flags(flags);
+	out.precision(precision);
+}
+
+void Profiler::WriteFoldedStacks(std::ostream& out) const
+{
+	for (auto& entry : stacks)
+	{
+		out << TOP_LEVEL;
+		for (auto function : entry.first)
+		{
+			out << ';' << GetName(function);
+		}
+		out << ' ' << entry.second << '\n';
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+# include "AST.h"
+# include <cstddef>
+# include <map>
+# include <ostream>
+# include <string>
+# include <unordered_map>
+# include <vector>
+
+// Профилировщик программ на DL
+// Исполнитель сообщает ему о каждом шаге цикла Eval, о вызовах функций
+// и о выходе из Eval. Каждый period-й шаг профилировщик снимает отсчёт:
+// запоминает выполняемое выражение и стэк вызванных функций.
+// По отсчётам строится отчёт о самых нагруженных функциях
+// и строках программы, а также файл свёрнутых стэков (folded stacks),
+// который принимают flamegraph.pl, speedscope и подобные инструменты.
+// Отсчёты берутся по шагам, а не по таймеру, поэтому профиль
+// воспроизводим и не зависит от платформы. Интервал между отсчётами
+// случайно меняется вокруг period (генератор с постоянным начальным значением),
+// чтобы отсчёты не попадали всё время в одну точку периодичного цикла
+class Profiler
+{
+	// Вызов функции на стэке профилировщика
+	// depth - глубина стэка областей видимости при входе в вызов Eval,
+	// выполняющий функцию. Хвостовой вызов выполняется тем же вызовом Eval,
+	// поэтому заменяет функцию с той же глубиной, а не добавляется к стэку
+	struct Frame
+	{
+		FunctionExpression* function;
+		size_t depth;
+	};
+
+	// Счётчики функции
+	struct FunctionSamples
+	{
+		size_t self = 0;  // Отсчётов, когда функция выполнялась сама
+		size_t total = 0; // Отсчётов, когда функция была на стэке
+	};
+
+	size_t period;            // Среднее число шагов между отсчётами
+	size_t countdown;         // Шагов до следующего отсчёта
+	unsigned int random = 1;  // Состояние генератора интервалов
+	size_t samples = 0;       // Снято отсчётов
+	std::vector<Frame> stack; // Стэк вызванных функций
+	std::unordered_map<FunctionExpression*, std::string> names; // Имена функций
+	std::unordered_map<FunctionExpression*, FunctionSamples> functions;
+	std::map<unsigned int, size_t> lines; // Отсчёты по строкам программы
+	std::map<std::vector<FunctionExpression*>, size_t> stacks; // Отсчёты по стэкам вызовов
+public:
+	Profiler(size_t period = 1000);
+
+	// Дать имена функциям программы
+	// Функция, значение <let> или <set>, получает имя переменной,
+	// остальные называются по имени аргумента
+	void Prepare(Expression* program);
+
+	// Шаг исполнителя: выполнение выражения expr
+	void Step(Expression* expr);
+
+	// Вызов функции из вызова Eval, начатого на глубине depth
+	void Call(FunctionExpression* function, size_t depth);
+
+	// Выход из вызова Eval, начатого на глубине depth
+	void Return(size_t depth);
+
+	// Вывести отчёт: функции и строки с наибольшим числом отсчётов
+	void Report(std::ostream&, size_t limit = 20) const;
+
+	// Вывести свёрнутые стэки: по строке "вызов;вызов;... число отсчётов" на стэк
+	void WriteFoldedStacks(std::ostream&) const;
+
+protected:
+	void Sample(Expression* expr); // Снять отсчёт
+	size_t NextInterval();         // Шагов до следующего отсчёта, от period / 2 до period * 3 / 2
+	void Name(Expression*);        // Дать имена функциям поддерева
+	std::string GetName(FunctionExpression*) const; // Имя функции с позицией определения
+};
+
+inline void Profiler::Step(Expression* expr)
+{
+	if (--countdown == 0)
+	{
+		countdown = NextInterval();
+		Sample(expr);
+	}
+}
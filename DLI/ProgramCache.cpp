@@ -0,0 +1,95 @@
+#include "ProgramCache.h"
+
+# include <functional>
+# include <iterator>
+
+size_t PreparedProgram::GetBytes() const
+{
+	size_t bytes = sizeof(PreparedProgram) + arena.GetStats().blockBytes;
+	if (bytecode)
+	{
+		bytes += sizeof(Program)
+			+ bytecode->GetSize() * (sizeof(Instruction) + sizeof(Expression*))
+			+ bytecode->GetFunctions().size() * sizeof(CompiledFunction);
+	}
+	if (thunks)
+		bytes += sizeof(ThunkProgram) + thunks->GetBytes();
+	return bytes;
+}
+
+ProgramCache::ProgramCache(size_t capacity) : capacity(capacity)
+{
+}
+
+std::shared_ptr<const PreparedProgram> ProgramCache::Find(std::string_view source)
+{
+	size_t hash = std::hash<std::string_view>()(source);
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto entry = Lookup(source, hash);
+	if (entry == entries.end())
+	{
+		stats.misses++;
+		return nullptr;
+	}
+
+	// Использованная запись переносится в начало списка
+	stats.hits++;
+	entries.splice(entries.begin(), entries, entry);
+	return entry->program;
+}
+
+// Программу мог одновременно подготовить и добавить другой поток,
+// тогда остаётся уже добавленная
+void ProgramCache::Insert(std::string_view source, std::shared_ptr<const PreparedProgram> program)
+{
+	size_t hash = std::hash<std::string_view>()(source);
+	size_t bytes = sizeof(Entry) + source.size() + program->GetBytes();
+	if (bytes > capacity) return;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (Lookup(source, hash) != entries.end()) return;
+
+	entries.push_front({ std::string(source), std::move(program), bytes });
+	index.emplace(hash, entries.begin());
+	stats.entries++;
+	stats.bytes += bytes;
+	Evict();
+}
+
+ProgramCacheStats ProgramCache::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return stats;
+}
+
+std::list<ProgramCache::Entry>::iterator ProgramCache::Lookup(std::string_view source, size_t hash)
+{
+	auto range = index.equal_range(hash);
+	for (auto it = range.first; it != range.second; it++)
+	{
+		if (it->second->source == source) return it->second;
+	}
+	return entries.end();
+}
+
+void ProgramCache::Evict()
+{
+	while (stats.bytes > capacity && !entries.empty())
+	{
+		auto last = std::prev(entries.end());
+		auto range = index.equal_range(std::hash<std::string_view>()(last->source));
+		for (auto it = range.first; it != range.second; it++)
+		{
+			if (it->second == last)
+			{
+				index.erase(it);
+				break;
+			}
+		}
+		stats.entries--;
+		stats.bytes -= last->bytes;
+		stats.evictions++;
+		entries.erase(last);
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+# include "AST.h"
+# include "Arena.h"
+# include "Bytecode.h"
+# include "ThunkCompiler.h"
+# include <cstddef>
+# include <list>
+# include <memory>
+# include <mutex>
+# include <string>
+# include <string_view>
+# include <unordered_map>
+
+// Программа, подготовленная к выполнению: AST после разрешения имён
+// и оптимизации в собственной арене и, для VirtualMachine и ThunkExecutor,
+// её байт-код или дерево узлов.
+// Подготовленная программа не меняется при выполнении, поэтому
+// её могут одновременно выполнять несколько исполнителей
+struct PreparedProgram
+{
+	// Арена с небольшими блоками: в кэше обычно много коротких программ,
+	// и блок размера по умолчанию в основном пустовал бы
+	static const size_t ARENA_BLOCK_SIZE = 4 * 1024;
+
+	Arena arena { ARENA_BLOCK_SIZE };  // Узлы AST программы
+	Expression* expression = nullptr;  // Корень AST
+	std::unique_ptr<Program> bytecode; // Байт-код, если программа компилировалась для VirtualMachine
+	std::unique_ptr<ThunkProgram> thunks; // Дерево узлов, если программа компилировалась для ThunkExecutor
+
+	// Занимаемый программой объём памяти
+	size_t GetBytes() const;
+};
+
+// Счётчики кэша
+struct ProgramCacheStats
+{
+	size_t hits = 0;      // Программа найдена в кэше
+	size_t misses = 0;    // Программа не найдена
+	size_t evictions = 0; // Вытеснено программ
+	size_t entries = 0;   // Программ в кэше
+	size_t bytes = 0;     // Занимаемый ими объём, вместе с текстом программ
+};
+
+// Кэш подготовленных программ
+// Программы ищутся по хэшу текста, при совпадении хэша текст сравнивается целиком.
+// Когда объём программ превышает capacity, вытесняются программы,
+// которые дольше всех не использовались (LRU).
+// Кэш разделяется между потоками. Вытесненная программа освобождается,
+// когда завершатся все её выполнения.
+// Символы AST принадлежат таблице символов, в которой программы разбирались,
+// поэтому таблица должна жить дольше кэша
+class ProgramCache
+{
+	// Запись кэша
+	struct Entry
+	{
+		std::string source;                              // Текст программы
+		std::shared_ptr<const PreparedProgram> program;  // Подготовленная программа
+		size_t bytes;                                    // Объём записи
+	};
+
+	size_t capacity;                // Наибольший объём программ, байт
+	std::list<Entry> entries;       // Записи, от последней использованной к самой давней
+	std::unordered_multimap<size_t, std::list<Entry>::iterator> index; // Записи по хэшу текста
+	ProgramCacheStats stats;
+	mutable std::mutex mutex;
+public:
+	ProgramCache(size_t capacity = 64 * 1024 * 1024);
+	ProgramCache(const ProgramCache&) = delete;
+	ProgramCache& operator=(const ProgramCache&) = delete;
+
+	// Найти программу по тексту, nullptr - программы нет в кэше
+	std::shared_ptr<const PreparedProgram> Find(std::string_view source);
+
+	// Добавить программу, вытеснив давно не использованные
+	// Программа больше всего кэша не добавляется
+	void Insert(std::string_view source, std::shared_ptr<const PreparedProgram> program);
+
+	ProgramCacheStats GetStats() const;
+
+protected:
+	// Найти запись по тексту и хэшу, entries.end() - записи нет
+	std::list<Entry>::iterator Lookup(std::string_view source, size_t hash);
+	void Evict(); // Вытеснять записи, пока объём больше capacity
+};
@@ -0,0 +1,143 @@
+#include "PurityAnalyzer.h"
+
+# include "Exceptions.h"
+# include <algorithm>
+# include <climits>
+
+namespace
+{
+	const int NO_ESCAPE = -1;
+
+	// Сводка двух поддеревьев, выполняемых в одной области видимости
+	void Combine(int& escape, bool& hasCall, int childEscape, bool childHasCall)
+	{
+		escape = std::max(escape, childEscape);
+		hasCall = hasCall || childHasCall;
+	}
+}
+
+// Первый проход выясняет, чисты ли тела всех функций,
+// второй отмечает узлы, уже зная, чисты ли вызовы
+void PurityAnalyzer::Analyze(Expression* expr)
+{
+	pureCalls = true;
+	marking = false;
+	Visit(expr);
+	marking = true;
+	Visit(expr);
+	marking = false;
+}
+
+bool PurityAnalyzer::IsPure(const Summary& summary) const
+{
+	return summary.escape < 0 && (!summary.hasCall || pureCalls);
+}
+
+PurityAnalyzer::Summary PurityAnalyzer::Visit(Expression* expr)
+{
+	Summary summary = { NO_ESCAPE, false };
+	switch (expr->GetKind())
+	{
+		case ExpressionKind::Val:
+		case ExpressionKind::Var:
+			break;
+		case ExpressionKind::Add:
+			summary = Visit(static_cast<AddExpression*>(expr));
+			break;
+		case ExpressionKind::If:
+			summary = Visit(static_cast<IfExpression*>(expr));
+			break;
+		case ExpressionKind::Let:
+			summary = Visit(static_cast<LetExpression*>(expr));
+			break;
+		case ExpressionKind::Function:
+			summary = Visit(static_cast<FunctionExpression*>(expr));
+			break;
+		case ExpressionKind::Call:
+			summary = Visit(static_cast<CallExpression*>(expr));
+			break;
+		case ExpressionKind::Set:
+			summary = Visit(static_cast<SetExpression*>(expr));
+			break;
+		case ExpressionKind::Block:
+			summary = Visit(static_cast<BlockExpression*>(expr));
+			break;
+		default:
+			throw UnknownExpressionException(expr);
+	}
+	return summary;
+}
+
+PurityAnalyzer::Summary PurityAnalyzer::Visit(AddExpression* expr)
+{
+	auto left = Visit(expr->GetLeftOperand());
+	auto right = Visit(expr->GetRightOperand());
+	if (marking) expr->SetParallel(IsPure(left) && IsPure(right) && left.hasCall && right.hasCall);
+	Combine(left.escape, left.hasCall, right.escape, right.hasCall);
+	return left;
+}
+
+PurityAnalyzer::Summary PurityAnalyzer::Visit(IfExpression* expr)
+{
+	auto left = Visit(expr->GetLeftOperand());
+	auto right = Visit(expr->GetRightOperand());
+	if (marking) expr->SetParallel(IsPure(left) && IsPure(right) && left.hasCall && right.hasCall);
+	Summary summary = left;
+	Combine(summary.escape, summary.hasCall, right.escape, right.hasCall);
+	for (auto branch : { expr->GetThenBranch(), expr->GetElseBranch() })
+	{
+		auto nested = Visit(branch);
+		Combine(summary.escape, summary.hasCall, nested.escape, nested.hasCall);
+	}
+	return summary;
+}
+
+// Значение и тело <let> выполняются в новой области видимости,
+// поэтому изменение её переменной не выходит за пределы <let>
+PurityAnalyzer::Summary PurityAnalyzer::Visit(LetExpression* expr)
+{
+	auto summary = Visit(expr->GetExpression());
+	auto body = Visit(expr->GetBody());
+	Combine(summary.escape, summary.hasCall, body.escape, body.hasCall);
+	summary.escape = std::max(NO_ESCAPE, summary.escape - 1);
+	return summary;
+}
+
+// Создание замыкания ничего не изменяет, тело выполняется при вызове
+// в области видимости вызова, где объявлен аргумент
+PurityAnalyzer::Summary PurityAnalyzer::Visit(FunctionExpression* expr)
+{
+	auto body = Visit(expr->GetBody());
+	if (body.escape - 1 >= 0) pureCalls = false;
+	return { NO_ESCAPE, false };
+}
+
+PurityAnalyzer::Summary PurityAnalyzer::Visit(CallExpression* expr)
+{
+	auto summary = Visit(expr->GetCallable());
+	auto argument = Visit(expr->GetArgument());
+	Combine(summary.escape, summary.hasCall, argument.escape, argument.hasCall);
+	summary.hasCall = true;
+	return summary;
+}
+
+// Глубина лексического адреса отсчитывается от области видимости <set>
+PurityAnalyzer::Summary PurityAnalyzer::Visit(SetExpression* expr)
+{
+	auto summary = Visit(expr->GetExpression());
+	auto& address = expr->GetAddress();
+	int escape = address.resolved ? (int)address.depth : INT_MAX;
+	summary.escape = std::max(summary.escape, escape);
+	return summary;
+}
+
+PurityAnalyzer::Summary PurityAnalyzer::Visit(BlockExpression* expr)
+{
+	Summary summary = { NO_ESCAPE, false };
+	for (auto nested : expr->GetExpressions())
+	{
+		auto item = Visit(nested);
+		Combine(summary.escape, summary.hasCall, item.escape, item.hasCall);
+	}
+	return summary;
+}
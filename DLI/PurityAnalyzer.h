@@ -0,0 +1,48 @@
+#pragma once
+
+# include "AST.h"
+
+// Анализ чистоты выражений
+// Единственный побочный эффект в языке - <set>. Выражение чисто, если все
+// его <set> изменяют только переменные, объявленные внутри него: их области
+// видимости создаются при его выполнении и никому больше не видны, - и если
+// вызываемые в нём функции тоже не изменяют внешних переменных.
+// Функции - значения, и какая будет вызвана, заранее неизвестно, поэтому
+// вызовы считаются чистыми, только если тело каждой функции программы
+// изменяет лишь её аргумент и объявленные в теле переменные.
+// У <add> и <if>, оба операнда которых чисты и содержат вызовы (долго
+// выполняться может только вызов), отмечается, что операнды можно вычислять
+// параллельно. Чистые операнды только читают общие области видимости,
+// поэтому результат не зависит от порядка их вычисления.
+// AST должно быть обработано Resolver, после оптимизации анализ выполняется заново
+class PurityAnalyzer
+{
+	// Сводка по поддереву
+	struct Summary
+	{
+		// На сколько областей видимости выше корня поддерева находится переменная,
+		// изменяемая самым внешним <set>, отрицательное значение - внешние
+		// переменные не изменяются
+		int escape;
+		bool hasCall;  // Содержит ли вызов, не считая тел функций
+	};
+
+	bool pureCalls = true; // Тела всех функций изменяют только собственные переменные
+	bool marking = false;  // Второй проход, на котором узлы отмечаются
+public:
+	// Отметить параллельные <add> и <if> во всём выражении
+	void Analyze(Expression*);
+
+protected:
+	Summary Visit(Expression*);
+	Summary Visit(AddExpression*);
+	Summary Visit(IfExpression*);
+	Summary Visit(LetExpression*);
+	Summary Visit(FunctionExpression*);
+	Summary Visit(CallExpression*);
+	Summary Visit(SetExpression*);
+	Summary Visit(BlockExpression*);
+
+	// Чисто ли выражение со сводкой summary
+	bool IsPure(const Summary&) const;
+};
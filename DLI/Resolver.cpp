@@ -0,0 +1,121 @@
+#include "Resolver.h"
+#include "Exceptions.h"
+
+// Создать разрешитель имён
+// Внешняя область видимости программы не содержит переменных
+Resolver::Resolver()
+{
+	frames.emplace_back();
+}
+
+// Разрешить имена в выражении
+void Resolver::Resolve(Expression* expr)
+{
+	switch (expr->GetKind())
+	{
+		case ExpressionKind::Var:
+			return Resolve(static_cast<VarExpression*>(expr));
+		case ExpressionKind::Add:
+			return Resolve(static_cast<AddExpression*>(expr));
+		case ExpressionKind::If:
+			return Resolve(static_cast<IfExpression*>(expr));
+		case ExpressionKind::Let:
+			return Resolve(static_cast<LetExpression*>(expr));
+		case ExpressionKind::Function:
+			return Resolve(static_cast<FunctionExpression*>(expr));
+		case ExpressionKind::Call:
+			return Resolve(static_cast<CallExpression*>(expr));
+		case ExpressionKind::Set:
+			return Resolve(static_cast<SetExpression*>(expr));
+		case ExpressionKind::Block:
+			return Resolve(static_cast<BlockExpression*>(expr));
+		default:
+			return;
+	}
+}
+
+void Resolver::Resolve(VarExpression* expr)
+{
+	expr->SetAddress(Lookup(expr->GetId(), expr->GetPosition()));
+}
+
+void Resolver::Resolve(AddExpression* expr)
+{
+	Resolve(expr->GetLeftOperand());
+	Resolve(expr->GetRightOperand());
+}
+
+void Resolver::Resolve(IfExpression* expr)
+{
+	Resolve(expr->GetLeftOperand());
+	Resolve(expr->GetRightOperand());
+	Resolve(expr->GetThenBranch());
+	Resolve(expr->GetElseBranch());
+}
+
+// <let> создаёт область видимости с одной ячейкой,
+// в которой выполняются и значение переменной, и тело
+// Значение переменной вычисляется уже в области видимости <let>, но
+// саму переменную видит только значение-функция, чтобы она могла ссылаться
+// на себя. В остальных значениях ячейка ещё не заполнена, поэтому имя
+// в них относится к внешней переменной, а на месте ячейки - пустой символ
+void Resolver::Resolve(LetExpression* expr)
+{
+	auto expression = expr->GetExpression();
+	frames.push_back({ expression->GetKind() == ExpressionKind::Function ? expr->GetId() : Symbol() });
+	Resolve(expression);
+	frames.back()[0] = expr->GetId();
+	Resolve(expr->GetBody());
+	frames.pop_back();
+}
+
+// Тело функции выполняется в области видимости с одной ячейкой - аргументом,
+// родительской для которой будет область видимости определения функции
+void Resolver::Resolve(FunctionExpression* expr)
+{
+	frames.push_back({ expr->GetArgument() });
+	Resolve(expr->GetBody());
+	frames.pop_back();
+}
+
+void Resolver::Resolve(CallExpression* expr)
+{
+	Resolve(expr->GetCallable());
+	Resolve(expr->GetArgument());
+}
+
+void Resolver::Resolve(SetExpression* expr)
+{
+	Resolve(expr->GetExpression());
+	expr->SetAddress(Lookup(expr->GetId(), expr->GetPosition()));
+}
+
+// <block> не может объявлять переменных,
+// поэтому собственной области видимости у него нет
+void Resolver::Resolve(BlockExpression* expr)
+{
+	for (auto nested : expr->GetExpressions())
+	{
+		Resolve(nested);
+	}
+}
+
+// Поднимаясь по областям видимости от текущей к внешней,
+// ищем ячейку с заданным именем
+// Символы сравниваются по указателю, без сравнения строк
+LexicalAddress Resolver::Lookup(Symbol id, const PositionInText& position) const
+{
+	LexicalAddress address;
+	for (auto frame = frames.rbegin(); frame != frames.rend(); frame++, address.depth++)
+	{
+		for (address.slot = 0; address.slot < frame->size(); address.slot++)
+		{
+			if ((*frame)[address.slot] == id)
+			{
+				address.resolved = true;
+				return address;
+			}
+		}
+	}
+	throw UndefinedVariableException(id.GetName(), position);
+}
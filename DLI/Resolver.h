@@ -0,0 +1,37 @@
+#pragma once
+
+# include "AST.h"
+# include <vector>
+
+// Разрешение имён переменных
+// Проход по AST после синтаксического анализа, который для каждого
+// выражения <var> и <set> вычисляет лексический адрес переменной.
+// Благодаря этому исполнителю не нужно искать переменные по имени
+
+class Resolver
+{
+	// Стэк областей видимости времени разбора,
+	// для каждой хранятся символы её ячеек в порядке номеров
+	std::vector<std::vector<Symbol>> frames;
+public:
+	Resolver();
+
+	// Разрешить имена во всём выражении
+	// Для неизвестной переменной будет выбрашено UndefinedVariableException
+	void Resolve(Expression*);
+
+protected:
+	// Методы для разрешения имён в конкретных выражениях
+	void Resolve(VarExpression*);
+	void Resolve(AddExpression*);
+	void Resolve(IfExpression*);
+	void Resolve(LetExpression*);
+	void Resolve(FunctionExpression*);
+	void Resolve(CallExpression*);
+	void Resolve(SetExpression*);
+	void Resolve(BlockExpression*);
+
+	// Найти лексический адрес переменной,
+	// Если она не найдена, будет выбрашено исключение
+	LexicalAddress Lookup(Symbol id, const PositionInText& position) const;
+};
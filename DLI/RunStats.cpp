@@ -0,0 +1,80 @@
+#include "RunStats.h"
+
+# include <iomanip>
+
+namespace
+{
+	// Суммарное время всех этапов
+	double TotalTime(const PhaseTimes& times)
+	{
+		return times.parse + times.resolve + times.optimize + times.compile + times.eval;
+	}
+
+	// Вывести время одного этапа
+	void PrintPhase(std::ostream& out, const char* name, double time)
+	{
+		out << "  " << std::left << std::setw(10) << name << std::right
+			<< std::fixed << std::setprecision(3) << std::setw(10) << time << " ms";
+	}
+}
+
+void PrintStats(std::ostream& out, const RunStats& stats)
+{
+	auto flags = out.flags();
+	auto precision = out.precision();
+
+	out << "Stats:" << std::endl;
+	PrintPhase(out, "parse", stats.times.parse);
+	out << " (" << stats.parser.tokens << " tokens, " << stats.parser.nodes << " nodes)" << std::endl;
+	PrintPhase(out, "resolve", stats.times.resolve);
+	out << std::endl;
+	PrintPhase(out, "optimize", stats.times.optimize);
+	out << std::endl;
+	PrintPhase(out, "compile", stats.times.compile);
+	out << std::endl;
+	PrintPhase(out, "eval", stats.times.eval);
+	out << " (" << stats.execution.steps << " steps, "
+		<< stats.execution.calls << " calls, "
+		<< stats.heap.scopesCreated << " scopes created, "
+		<< "max depth " << stats.execution.maxDepth << ")" << std::endl;
+	PrintPhase(out, "total", TotalTime(stats.times));
+	out << std::endl;
+	out << "  gc        " << stats.heap.collections << " collections, "
+		<< stats.heap.scopesFreed << " scopes freed, "
+		<< "pause " << stats.heap.pauseTime << " ms, "
+		<< "peak " << stats.heap.peakBytes << " bytes" << std::endl;
+
+	out.flags(flags);
+	out.precision(precision);
+}
+
+void PrintStatsJson(std::ostream& out, const RunStats& stats)
+{
+	auto flags = out.flags();
+	auto precision = out.precision();
+
+	out << std::fixed << std::setprecision(3)
+		<< "{\"times\": {"
+		<< "\"parse\": " << stats.times.parse << ", "
+		<< "\"resolve\": " << stats.times.resolve << ", "
+		<< "\"optimize\": " << stats.times.optimize << ", "
+		<< "\"compile\": " << stats.times.compile << ", "
+		<< "\"eval\": " << stats.times.eval << ", "
+		<< "\"total\": " << TotalTime(stats.times) << "}, "
+		<< "\"tokens\": " << stats.parser.tokens << ", "
+		<< "\"nodes\": " << stats.parser.nodes << ", "
+		<< "\"steps\": " << stats.execution.steps << ", "
+		<< "\"calls\": " << stats.execution.calls << ", "
+		<< "\"scopesCreated\": " << stats.heap.scopesCreated << ", "
+		<< "\"maxDepth\": " << stats.execution.maxDepth << ", "
+		<< "\"gc\": {"
+		<< "\"collections\": " << stats.heap.collections << ", "
+		<< "\"scopesFreed\": " << stats.heap.scopesFreed << ", "
+		<< "\"bytesFreed\": " << stats.heap.bytesFreed << ", "
+		<< "\"pauseTime\": " << stats.heap.pauseTime << ", "
+		<< "\"maxPause\": " << stats.heap.maxPause << ", "
+		<< "\"peakBytes\": " << stats.heap.peakBytes << "}}" << std::endl;
+
+	out.flags(flags);
+	out.precision(precision);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+# include "Parser.h"
+# include "ExecutionStats.h"
+# include "Heap.h"
+# include <ostream>
+
+// Сводка по обработке одной программы: время каждого этапа
+// и счётчики анализатора, исполнителя и кучи
+
+// Время этапов, мс
+// Лексический анализ выполняется по мере чтения лексем
+// синтаксическим анализатором, поэтому входит во время parse
+struct PhaseTimes
+{
+	double parse = 0;
+	double resolve = 0;
+	double optimize = 0;
+	double compile = 0; // Компиляция в байт-код (--vm) или в дерево узлов (--thunks)
+	double eval = 0;
+};
+
+struct RunStats
+{
+	PhaseTimes times;
+	ParserStats parser;
+	ExecutionStats execution;
+	HeapStats heap;
+};
+
+// Вывести сводку в виде текста
+void PrintStats(std::ostream&, const RunStats&);
+
+// Вывести сводку в виде объекта JSON
+void PrintStatsJson(std::ostream&, const RunStats&);
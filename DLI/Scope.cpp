@@ -0,0 +1,70 @@
+#include "Scope.h"
+#include "Heap.h"
+
+Scope::Scope(std::shared_ptr<Scope> parent, size_t size) : parentScope(std::move(parent))
+{
+	AllocateSlots(size);
+}
+
+// Создать область видимости, память которой учитывает куча heap
+Scope::Scope(Heap* heap, std::shared_ptr<Scope> parent, size_t size) : parentScope(std::move(parent))
+{
+	AllocateSlots(size);
+	heap->Register(this);
+}
+
+// Выделить ячейки: небольшие области видимости обходятся
+// ячейками внутри объекта, без отдельного выделения памяти
+void Scope::AllocateSlots(size_t size)
+{
+	this->size = size;
+	if (size > INLINE_SLOTS)
+	{
+		allocatedSlots.reset(new Value[size]);
+		slots = allocatedSlots.get();
+	}
+}
+
+void Scope::Clear()
+{
+	for (size_t i = 0; i < size; i++)
+	{
+		slots[i] = Value();
+	}
+	parentScope.reset();
+}
+
+Scope::~Scope()
+{
+	if (heap) heap->Unregister(this);
+}
+
+// Получить ячейку по лексическому адресу:
+// подняться на address.depth областей видимости вверх
+// и взять ячейку с номером address.slot
+Value& Scope::Lookup(const LexicalAddress& address)
+{
+	Scope* scope = this;
+	for (unsigned int i = 0; i < address.depth; i++)
+	{
+		scope = scope->parentScope.get();
+	}
+	return scope->slots[address.slot];
+}
+
+// Получить ячейку текущей области видимости
+Value& Scope::GetSlot(unsigned int slot)
+{
+	return slots[slot];
+}
+
+// Получить родительскую область видимости
+const std::shared_ptr<Scope>& Scope::GetParent() const
+{
+	return parentScope;
+}
+
+size_t Scope::GetBytes() const
+{
+	return sizeof(Scope) + (allocatedSlots ? size * sizeof(Value) : 0);
+}
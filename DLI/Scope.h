@@ -0,0 +1,63 @@
+#pragma once
+
+# include "AST.h"
+# include "Value.h"
+# include <memory>
+# include <vector>
+
+class Heap;
+
+// Класс - абстракция области видимости
+// Переменные хранятся в массиве ячеек, номера которых
+// заранее вычислены Resolver, поиск по имени не требуется.
+// Область видимости принадлежит всем, кто на неё ссылается:
+// исполнителю, пока он в ней выполняет код, дочерним областям
+// и замыканиям, поэтому она живёт, пока нужна хотя бы одному из них.
+// Циклические ссылки через замыкания освобождает сборщик Heap
+class Scope : public std::enable_shared_from_this<Scope>
+{
+	// Области видимости <let> и функций содержат по одной ячейке,
+	// она хранится прямо в объекте, а большие массивы ячеек выделяются отдельно
+	static const size_t INLINE_SLOTS = 1;
+
+	std::shared_ptr<Scope> parentScope; // Родительская области видимости
+	Value inlineSlots[INLINE_SLOTS];    // Ячейки небольшой области видимости
+	std::unique_ptr<Value[]> allocatedSlots; // Ячейки большой области видимости
+	Value* slots = inlineSlots;         // Значения, хранящиеся в области видимости
+	size_t size = 0;                    // Число ячеек
+
+	// Куча, в которой зарегистрирована область видимости,
+	// и соседи в её списке областей видимости
+	Heap* heap = nullptr;
+	Scope* previous = nullptr;
+	Scope* next = nullptr;
+
+	// Рабочие поля сборщика циклов
+	long gcReferences = 0;
+	bool gcReachable = false;
+
+	void AllocateSlots(size_t size);
+	void Clear(); // Очистить ячейки и ссылку на родителя, разрывая циклы
+
+	friend class Heap;
+public:
+	Scope() {}
+	Scope(std::shared_ptr<Scope> parent, size_t size);
+	Scope(Heap* heap, std::shared_ptr<Scope> parent, size_t size);
+	Scope(const Scope&) = delete;
+	Scope& operator=(const Scope&) = delete;
+	~Scope();
+
+	// Получить ячейку по лексическому адресу,
+	// отсчитывая глубину от текущей области видимости
+	Value& Lookup(const LexicalAddress& address);
+
+	// Ячейка текущей области видимости
+	Value& GetSlot(unsigned int slot);
+
+	// Родительская область видимости
+	const std::shared_ptr<Scope>& GetParent() const;
+
+	// Объём памяти, занимаемый областью видимости
+	size_t GetBytes() const;
+};
@@ -0,0 +1,321 @@
+#include "Serialization.h"
+
+# include "Exceptions.h"
+# include <cstring>
+# include <string_view>
+# include <unordered_map>
+# include <vector>
+
+namespace
+{
+	const char MAGIC[4] = { 'D', 'L', 'I', 'A' };
+	const size_t HEADER_WORDS = 6;   // Слов заголовка после "DLIA"
+	const size_t HEADER_SIZE = sizeof(MAGIC) + HEADER_WORDS * 4;
+	const size_t NODE_WORDS = 7;     // Слов в записи узла
+
+	// Контрольная сумма FNV-1a
+	unsigned int Checksum(const char* data, size_t size)
+	{
+		unsigned int hash = 2166136261u;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= (unsigned char)data[i];
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
+	void WriteWord(std::string& out, unsigned int value)
+	{
+		char bytes[4] = { (char)(value & 0xFF), (char)((value >> 8) & 0xFF),
+			(char)((value >> 16) & 0xFF), (char)((value >> 24) & 0xFF) };
+		out.append(bytes, 4);
+	}
+
+	unsigned int ReadWord(const char* data)
+	{
+		auto bytes = reinterpret_cast<const unsigned char*>(data);
+		return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+	}
+
+	// Запись AST в двоичный формат
+	// Узлы нумеруются в обратном порядке обхода
+	// Общих поддеревьев в AST нет, поэтому каждый узел записывается один раз
+	class Writer
+	{
+		std::vector<unsigned int> nodes;  // Записи узлов, по NODE_WORDS слов
+		std::vector<unsigned int> items;  // Вложенные выражения блоков
+		std::vector<const std::string*> names;
+		std::unordered_map<const std::string*, unsigned int> nameIndex;
+	public:
+		std::string Write(Expression* root)
+		{
+			unsigned int rootIndex = Add(root);
+
+			std::string payload;
+			for (auto name : names)
+			{
+				WriteWord(payload, (unsigned int)name->size());
+				payload += *name;
+			}
+			for (auto word : nodes)
+			{
+				WriteWord(payload, word);
+			}
+			for (auto item : items)
+			{
+				WriteWord(payload, item);
+			}
+
+			std::string out(MAGIC, sizeof(MAGIC));
+			WriteWord(out, SERIALIZED_PROGRAM_VERSION);
+			WriteWord(out, (unsigned int)names.size());
+			WriteWord(out, (unsigned int)(nodes.size() / NODE_WORDS));
+			WriteWord(out, (unsigned int)items.size());
+			WriteWord(out, rootIndex);
+			WriteWord(out, Checksum(payload.data(), payload.size()));
+			out += payload;
+			return out;
+		}
+
+	protected:
+		unsigned int Name(Symbol symbol)
+		{
+			auto name = &symbol.GetName();
+			auto found = nameIndex.find(name);
+			if (found != nameIndex.end()) return found->second;
+			unsigned int index = (unsigned int)names.size();
+			names.push_back(name);
+			nameIndex.emplace(name, index);
+			return index;
+		}
+
+		// Добавить узел после его операндов, вернуть его номер
+		unsigned int Add(Expression* expr)
+		{
+			unsigned int operands[4] = { 0, 0, 0, 0 };
+			switch (expr->GetKind())
+			{
+				case ExpressionKind::Val:
+					operands[0] = (unsigned int)static_cast<ValExpression*>(expr)->GetValue();
+					break;
+				case ExpressionKind::Var:
+					operands[0] = Name(static_cast<VarExpression*>(expr)->GetId());
+					break;
+				case ExpressionKind::Add:
+				{
+					auto add = static_cast<AddExpression*>(expr);
+					operands[0] = Add(add->GetLeftOperand());
+					operands[1] = Add(add->GetRightOperand());
+					break;
+				}
+				case ExpressionKind::If:
+				{
+					auto ifExpr = static_cast<IfExpression*>(expr);
+					operands[0] = Add(ifExpr->GetLeftOperand());
+					operands[1] = Add(ifExpr->GetRightOperand());
+					operands[2] = Add(ifExpr->GetThenBranch());
+					operands[3] = Add(ifExpr->GetElseBranch());
+					break;
+				}
+				case ExpressionKind::Let:
+				{
+					auto let = static_cast<LetExpression*>(expr);
+					operands[0] = Name(let->GetId());
+					operands[1] = Add(let->GetExpression());
+					operands[2] = Add(let->GetBody());
+					break;
+				}
+				case ExpressionKind::Function:
+				{
+					auto function = static_cast<FunctionExpression*>(expr);
+					operands[0] = Name(function->GetArgument());
+					operands[1] = Add(function->GetBody());
+					break;
+				}
+				case ExpressionKind::Call:
+				{
+					auto call = static_cast<CallExpression*>(expr);
+					operands[0] = Add(call->GetCallable());
+					operands[1] = Add(call->GetArgument());
+					break;
+				}
+				case ExpressionKind::Set:
+				{
+					auto set = static_cast<SetExpression*>(expr);
+					operands[0] = Name(set->GetId());
+					operands[1] = Add(set->GetExpression());
+					break;
+				}
+				case ExpressionKind::Block:
+				{
+					// Номера вложенных выражений известны только после их записи,
+					// поэтому список блока добавляется после них
+					std::vector<unsigned int> nested;
+					for (auto item : static_cast<BlockExpression*>(expr)->GetExpressions())
+					{
+						nested.push_back(Add(item));
+					}
+					operands[0] = (unsigned int)items.size();
+					operands[1] = (unsigned int)nested.size();
+					items.insert(items.end(), nested.begin(), nested.end());
+					break;
+				}
+				default:
+					throw UnknownExpressionException(expr);
+			}
+
+			unsigned int index = (unsigned int)(nodes.size() / NODE_WORDS);
+			nodes.push_back((unsigned int)expr->GetKind());
+			nodes.push_back(expr->GetPosition().row);
+			nodes.push_back(expr->GetPosition().col);
+			nodes.insert(nodes.end(), operands, operands + 4);
+			return index;
+		}
+	};
+
+	// Проверка, что значение не выходит за границу
+	void Check(bool condition, const char* reason)
+	{
+		if (!condition) throw InvalidProgramFileException(reason);
+	}
+}
+
+std::string SerializeProgram(Expression* root)
+{
+	Writer writer;
+	return writer.Write(root);
+}
+
+bool IsSerializedProgram(const char* data, size_t size)
+{
+	return size >= sizeof(MAGIC) && std::memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+// Узлы создаются по порядку записей: операнды каждого узла уже созданы
+// Каждый узел, кроме корня, должен быть операндом ровно одного узла:
+// общие поддеревья ломают лексические адреса, которые Resolver
+// записывает в узлы, и экспоненциально увеличивают время обхода
+Expression* DeserializeProgram(const char* data, size_t size, Arena& arena, SymbolTable& symbols)
+{
+	Check(IsSerializedProgram(data, size), "not a DL program file");
+	Check(size >= HEADER_SIZE, "truncated header");
+
+	const char* header = data + sizeof(MAGIC);
+	unsigned int version = ReadWord(header);
+	if (version != SERIALIZED_PROGRAM_VERSION)
+		throw InvalidProgramFileException("unsupported format version " + std::to_string(version)
+			+ ", expected " + std::to_string(SERIALIZED_PROGRAM_VERSION));
+	size_t nameCount = ReadWord(header + 4);
+	size_t nodeCount = ReadWord(header + 8);
+	size_t itemCount = ReadWord(header + 12);
+	size_t root = ReadWord(header + 16);
+	unsigned int checksum = ReadWord(header + 20);
+
+	const char* current = data + HEADER_SIZE;
+	const char* end = data + size;
+	Check(Checksum(current, end - current) == checksum, "checksum mismatch");
+
+	// Каждое имя занимает не меньше 4 байт, каждый узел - NODE_WORDS слов,
+	// поэтому до выделения памяти числа проверяются по размеру данных
+	size_t words = (end - current) / 4;
+	Check(nameCount <= words && nodeCount <= words / NODE_WORDS && itemCount <= words
+		&& nameCount + nodeCount * NODE_WORDS + itemCount <= words, "invalid header");
+
+	// Имена
+	std::vector<Symbol> names;
+	names.reserve(nameCount);
+	for (size_t i = 0; i < nameCount; i++)
+	{
+		Check(end - current >= 4, "truncated name table");
+		size_t length = ReadWord(current);
+		current += 4;
+		Check((size_t)(end - current) >= length, "truncated name table");
+		names.push_back(symbols.Intern(std::string_view(current, length)));
+		current += length;
+	}
+
+	// Размер записей узлов и списков блоков известен заранее
+	Check(nodeCount > 0 && root < nodeCount, "invalid root");
+	Check((size_t)(end - current) / 4 / NODE_WORDS >= nodeCount, "truncated node table");
+	const char* nodeData = current;
+	current += nodeCount * NODE_WORDS * 4;
+	Check((size_t)(end - current) / 4 == itemCount && (size_t)(end - current) % 4 == 0, "invalid block table");
+	const char* itemData = current;
+
+	std::vector<Expression*> nodes(nodeCount);
+	std::vector<bool> referenced(nodeCount);  // Является ли узел уже чьим-то операндом
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		const char* record = nodeData + i * NODE_WORDS * 4;
+		unsigned int kind = ReadWord(record);
+		PositionInText position(ReadWord(record + 4), ReadWord(record + 8));
+		unsigned int operands[4];
+		for (size_t k = 0; k < 4; k++)
+		{
+			operands[k] = ReadWord(record + 12 + k * 4);
+		}
+		auto node = [&](unsigned int index)
+		{
+			Check(index < i && !referenced[index], "invalid node reference");
+			referenced[index] = true;
+			return nodes[index];
+		};
+		auto name = [&](unsigned int index)
+		{
+			Check(index < names.size(), "invalid name reference");
+			return names[index];
+		};
+
+		switch ((ExpressionKind)kind)
+		{
+			case ExpressionKind::Val:
+				nodes[i] = arena.Create<ValExpression>((int)operands[0], position);
+				break;
+			case ExpressionKind::Var:
+				nodes[i] = arena.Create<VarExpression>(name(operands[0]), position);
+				break;
+			case ExpressionKind::Add:
+				nodes[i] = arena.Create<AddExpression>(node(operands[0]), node(operands[1]), position);
+				break;
+			case ExpressionKind::If:
+				nodes[i] = arena.Create<IfExpression>(node(operands[0]), node(operands[1]),
+					node(operands[2]), node(operands[3]), position);
+				break;
+			case ExpressionKind::Let:
+				nodes[i] = arena.Create<LetExpression>(name(operands[0]), node(operands[1]), node(operands[2]), position);
+				break;
+			case ExpressionKind::Function:
+				nodes[i] = arena.Create<FunctionExpression>(name(operands[0]), node(operands[1]), position);
+				break;
+			case ExpressionKind::Call:
+				nodes[i] = arena.Create<CallExpression>(node(operands[0]), node(operands[1]), position);
+				break;
+			case ExpressionKind::Set:
+				nodes[i] = arena.Create<SetExpression>(name(operands[0]), node(operands[1]), position);
+				break;
+			case ExpressionKind::Block:
+			{
+				size_t first = operands[0];
+				size_t count = operands[1];
+				Check(count > 0 && first <= itemCount && count <= itemCount - first, "invalid block");
+				auto items = arena.CreateArray<Expression>(count);
+				for (size_t k = 0; k < count; k++)
+				{
+					items[k] = node(ReadWord(itemData + (first + k) * 4));
+				}
+				nodes[i] = arena.Create<BlockExpression>(ExpressionList(items, count), position);
+				break;
+			}
+			default:
+				throw InvalidProgramFileException("unknown node type " + std::to_string(kind));
+		}
+	}
+
+	Check(!referenced[root], "invalid root");
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		Check(referenced[i] || i == root, "unreferenced node");
+	}
+	return nodes[root];
+}
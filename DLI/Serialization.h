@@ -0,0 +1,43 @@
+#pragma once
+
+# include "AST.h"
+# include "Arena.h"
+# include "SymbolTable.h"
+# include <cstddef>
+# include <string>
+
+// Двоичный формат AST
+// Подготовленную программу можно сохранить и затем загрузить без лексического
+// и синтаксического анализа: узлы создаются в арене прямо из массива записей.
+//
+// Все числа - 32-битные без знака, little-endian. Файл состоит из
+//   заголовка:  "DLIA", версия формата, число имён, число узлов,
+//               число вложенных выражений блоков, номер корня,
+//               контрольная сумма (FNV-1a) всего, что следует за заголовком;
+//   имён:       длина и байты каждого имени;
+//   узлов:      записи из 7 чисел - тип узла, строка, столбец и до 4 операндов.
+//               Операнд - номер имени, номер узла, значение <val>
+//               или, для <block>, начало и длина его списка вложенных выражений.
+//               Узлы записаны в обратном порядке обхода: операнды узла
+//               всегда записаны раньше него, поэтому циклов в загруженном AST нет.
+//               Каждый узел, кроме корня, - операнд ровно одного узла;
+//   вложенных выражений блоков: номера узлов.
+//
+// Лексические адреса переменных не сохраняются: после загрузки
+// AST обрабатывается Resolver, который заодно проверяет имена
+
+// Текущая версия формата
+// Увеличивается при любом изменении формата, файлы других версий не загружаются
+const unsigned int SERIALIZED_PROGRAM_VERSION = 1;
+
+// Представить AST в двоичном формате
+std::string SerializeProgram(Expression* root);
+
+// Начинаются ли данные с заголовка двоичного формата
+bool IsSerializedProgram(const char* data, size_t size);
+
+// Загрузить AST из двоичного формата
+// Узлы создаются в arena, имена добавляются в symbols.
+// Неверные данные (другая версия, несовпадение контрольной суммы,
+// выход номеров за границы, общие или лишние узлы) вызывают InvalidProgramFileException
+Expression* DeserializeProgram(const char* data, size_t size, Arena& arena, SymbolTable& symbols);
@@ -0,0 +1,32 @@
+#include "SymbolTable.h"
+
+# include <mutex>
+
+// Ключи словаря ссылаются на строки, хранящиеся в names,
+// поэтому имя копируется только при первом появлении.
+// Почти все имена уже есть в таблице, поэтому сначала
+// ищем под разделяемой блокировкой, не мешая другим потокам
+Symbol SymbolTable::Intern(std::string_view name)
+{
+	{
+		std::shared_lock<std::shared_mutex> lock(mutex);
+		auto found = symbols.find(name);
+		if (found != symbols.end()) return found->second;
+	}
+
+	// Пока блокировки не было, имя мог добавить другой поток
+	std::unique_lock<std::shared_mutex> lock(mutex);
+	auto found = symbols.find(name);
+	if (found != symbols.end()) return found->second;
+
+	auto& stored = names.emplace_back(name);
+	Symbol symbol(&stored);
+	symbols.emplace(std::string_view(stored), symbol);
+	return symbol;
+}
+
+size_t SymbolTable::GetSize() const
+{
+	std::shared_lock<std::shared_mutex> lock(mutex);
+	return symbols.size();
+}
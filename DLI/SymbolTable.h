@@ -0,0 +1,45 @@
+#pragma once
+
+# include <string>
+# include <string_view>
+# include <deque>
+# include <shared_mutex>
+# include <unordered_map>
+
+// Символ - имя переменной, сохранённое в таблице символов
+// Одинаковым именам соответствует один и тот же символ,
+// поэтому символы сравниваются по указателю, а не по тексту
+class Symbol
+{
+	const std::string* name = nullptr;
+public:
+	Symbol() {}
+	explicit Symbol(const std::string* name) : name(name) {}
+	const std::string& GetName() const { return *name; }
+	bool operator==(const Symbol& other) const { return name == other.name; }
+	bool operator!=(const Symbol& other) const { return name != other.name; }
+};
+
+// Таблица символов
+// Лексический анализатор помещает в неё идентификаторы при чтении,
+// каждое имя хранится в единственном экземпляре.
+// Таблица должна жить дольше AST и значений, которые ссылаются на её символы.
+// Одну таблицу могут использовать несколько потоков: поиск имени
+// выполняется под разделяемой блокировкой, добавление - под исключительной,
+// а символы после добавления не меняются
+class SymbolTable
+{
+	std::deque<std::string> names;                     // Имена (адреса строк в deque не меняются)
+	std::unordered_map<std::string_view, Symbol> symbols; // Символы по имени
+	mutable std::shared_mutex mutex;                   // Блокировка для доступа из нескольких потоков
+public:
+	SymbolTable() {}
+	SymbolTable(const SymbolTable&) = delete;
+	SymbolTable& operator=(const SymbolTable&) = delete;
+
+	// Получить символ для имени, добавив его в таблицу при необходимости
+	Symbol Intern(std::string_view name);
+
+	// Количество различных имён
+	size_t GetSize() const;
+};
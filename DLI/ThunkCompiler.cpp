@@ -0,0 +1,152 @@
+#include "ThunkCompiler.h"
+
+# include "ThunkExecutor.h"
+# include "Exceptions.h"
+
+namespace
+{
+	// Вид операнда определяет, какой вариант функции <add> или <if> будет выбран
+	OperandKind GetOperandKind(Expression* expr)
+	{
+		switch (expr->GetKind())
+		{
+			case ExpressionKind::Val:
+				return OperandKind::Val;
+			case ExpressionKind::Var:
+				return OperandKind::Var;
+			default:
+				return OperandKind::Other;
+		}
+	}
+}
+
+const Thunk* ThunkProgram::GetRoot() const
+{
+	return root;
+}
+
+const Thunk* ThunkProgram::GetFunctionBody(size_t function) const
+{
+	return functions[function];
+}
+
+size_t ThunkProgram::GetBytes() const
+{
+	return arena.GetStats().blockBytes + functions.capacity() * sizeof(const Thunk*);
+}
+
+// Скомпилировать программу
+std::unique_ptr<ThunkProgram> ThunkCompiler::Compile(Expression* expr)
+{
+	auto compiled = std::make_unique<ThunkProgram>();
+	program = compiled.get();
+	program->root = CompileExpression(expr);
+	program = nullptr;
+	return compiled;
+}
+
+const Thunk* ThunkCompiler::CompileExpression(Expression* expr)
+{
+	switch (expr->GetKind())
+	{
+		case ExpressionKind::Val:
+			return CompileExpression(static_cast<ValExpression*>(expr));
+		case ExpressionKind::Var:
+			return CompileExpression(static_cast<VarExpression*>(expr));
+		case ExpressionKind::Add:
+			return CompileExpression(static_cast<AddExpression*>(expr));
+		case ExpressionKind::If:
+			return CompileExpression(static_cast<IfExpression*>(expr));
+		case ExpressionKind::Let:
+			return CompileExpression(static_cast<LetExpression*>(expr));
+		case ExpressionKind::Function:
+			return CompileExpression(static_cast<FunctionExpression*>(expr));
+		case ExpressionKind::Call:
+			return CompileExpression(static_cast<CallExpression*>(expr));
+		case ExpressionKind::Set:
+			return CompileExpression(static_cast<SetExpression*>(expr));
+		case ExpressionKind::Block:
+			return CompileExpression(static_cast<BlockExpression*>(expr));
+		default:
+			throw UnknownExpressionException(expr);
+	}
+}
+
+const Thunk* ThunkCompiler::CompileExpression(ValExpression* expr)
+{
+	return Create<ValThunk>(Thunk(ThunkExecutor::RunVal, ThunkExecutor::IntegerVal, expr), expr->GetValue());
+}
+
+const Thunk* ThunkCompiler::CompileExpression(VarExpression* expr)
+{
+	auto& address = expr->GetAddress();
+	if (!address.resolved)
+		throw UndefinedVariableException(expr->GetId().GetName(), expr->GetPosition());
+	return Create<VarThunk>(Thunk(ThunkExecutor::RunVar, ThunkExecutor::IntegerVar, expr), address);
+}
+
+const Thunk* ThunkCompiler::CompileExpression(AddExpression* expr)
+{
+	auto left = GetOperandKind(expr->GetLeftOperand());
+	auto right = GetOperandKind(expr->GetRightOperand());
+	Thunk thunk(ThunkExecutor::addFunctions[(int)left][(int)right],
+		ThunkExecutor::integerAddFunctions[(int)left][(int)right], expr);
+	return Create<BinaryThunk>(thunk, CompileExpression(expr->GetLeftOperand()), CompileExpression(expr->GetRightOperand()));
+}
+
+const Thunk* ThunkCompiler::CompileExpression(IfExpression* expr)
+{
+	auto left = GetOperandKind(expr->GetLeftOperand());
+	auto right = GetOperandKind(expr->GetRightOperand());
+	Thunk thunk(ThunkExecutor::ifFunctions[(int)left][(int)right], ThunkExecutor::IntegerOther, expr, true);
+	return Create<IfThunk>(thunk, CompileExpression(expr->GetLeftOperand()), CompileExpression(expr->GetRightOperand()),
+		CompileExpression(expr->GetThenBranch()), CompileExpression(expr->GetElseBranch()));
+}
+
+// У <let> левый операнд - значение переменной, правый - тело
+const Thunk* ThunkCompiler::CompileExpression(LetExpression* expr)
+{
+	Thunk thunk(ThunkExecutor::RunLet, ThunkExecutor::IntegerOther, expr, true);
+	return Create<BinaryThunk>(thunk, CompileExpression(expr->GetExpression()), CompileExpression(expr->GetBody()));
+}
+
+// Тело функции компилируется один раз и попадает в таблицу функций,
+// замыкание хранит номер функции в ней
+const Thunk* ThunkCompiler::CompileExpression(FunctionExpression* expr)
+{
+	size_t function = program->functions.size();
+	program->functions.push_back(nullptr);
+	program->functions[function] = CompileExpression(expr->GetBody());
+	return Create<FunctionThunk>(Thunk(ThunkExecutor::RunFunction, ThunkExecutor::IntegerOther, expr), function);
+}
+
+// Вызываемое выражение обычно переменная, для неё замыкание
+// читается из ячейки без копирования
+const Thunk* ThunkCompiler::CompileExpression(CallExpression* expr)
+{
+	bool isVar = expr->GetCallable()->GetKind() == ExpressionKind::Var;
+	Thunk thunk(isVar ? ThunkExecutor::RunCallVar : ThunkExecutor::RunCall, ThunkExecutor::IntegerOther, expr, true);
+	return Create<BinaryThunk>(thunk, CompileExpression(expr->GetCallable()), CompileExpression(expr->GetArgument()));
+}
+
+const Thunk* ThunkCompiler::CompileExpression(SetExpression* expr)
+{
+	auto& address = expr->GetAddress();
+	if (!address.resolved)
+		throw UndefinedVariableException(expr->GetId().GetName(), expr->GetPosition());
+	Thunk thunk(ThunkExecutor::RunSet, ThunkExecutor::IntegerOther, expr);
+	return Create<SetThunk>(thunk, address, CompileExpression(expr->GetExpression()));
+}
+
+const Thunk* ThunkCompiler::CompileExpression(BlockExpression* expr)
+{
+	auto& expressions = expr->GetExpressions();
+	auto items = program->arena.CreateArray<const Thunk>(expressions.size());
+	size_t count = 0;
+	for (auto nested : expressions)
+	{
+		items[count++] = CompileExpression(nested);
+	}
+	Thunk thunk(ThunkExecutor::RunBlock, ThunkExecutor::IntegerOther, expr, true);
+	return Create<BlockThunk>(thunk, items, count);
+}
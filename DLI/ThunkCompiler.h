@@ -0,0 +1,144 @@
+#pragma once
+
+# include "AST.h"
+# include "Arena.h"
+# include "Value.h"
+# include <cstddef>
+# include <memory>
+# include <utility>
+# include <vector>
+
+// Компиляция AST в дерево заранее связанных узлов (thunk)
+// Каждый узел AST один раз превращается в структуру с указателем на функцию,
+// которая его выполняет, и уже связанными операндами: вложенными узлами,
+// лексическими адресами переменных и значениями литералов.
+// Во время выполнения тип узла не проверяется и AST не обходится,
+// а функции для частых сочетаний операндов <add> и <if> (литералы
+// и переменные) выбираются при компиляции
+
+class ThunkExecutor;
+struct Thunk;
+
+// Выполнить узел
+// Значение узла записывается в result. Если узел завершается выражением
+// в хвостовой позиции, функция возвращает его узел, и тот выполняется
+// в цикле исполнителя, иначе возвращается nullptr
+using ThunkFunction = const Thunk* (*)(const Thunk*, ThunkExecutor&, Value& result);
+
+// Выполнить узел, значение которого должно быть целым
+using IntegerThunkFunction = int (*)(const Thunk*, ThunkExecutor&);
+
+// Скомпилированный узел
+struct Thunk
+{
+	ThunkFunction run;
+	IntegerThunkFunction integer;
+	Expression* source;   // Узел AST, для сообщений об ошибках
+	bool tail;            // Может ли узел завершиться выражением в хвостовой позиции
+
+	Thunk(ThunkFunction run, IntegerThunkFunction integer, Expression* source, bool tail = false)
+		: run(run), integer(integer), source(source), tail(tail) {}
+};
+
+struct ValThunk : Thunk
+{
+	int value;
+	ValThunk(const Thunk& thunk, int value) : Thunk(thunk), value(value) {}
+};
+
+// <var> и <set> хранят уже вычисленный лексический адрес
+struct VarThunk : Thunk
+{
+	LexicalAddress address;
+	VarThunk(const Thunk& thunk, const LexicalAddress& address) : Thunk(thunk), address(address) {}
+};
+
+struct SetThunk : Thunk
+{
+	LexicalAddress address;
+	const Thunk* expression;
+	SetThunk(const Thunk& thunk, const LexicalAddress& address, const Thunk* expression)
+		: Thunk(thunk), address(address), expression(expression) {}
+};
+
+// Два операнда: <add>, <let> (значение и тело) и <call> (функция и аргумент)
+struct BinaryThunk : Thunk
+{
+	const Thunk* left;
+	const Thunk* right;
+	BinaryThunk(const Thunk& thunk, const Thunk* left, const Thunk* right) : Thunk(thunk), left(left), right(right) {}
+};
+
+struct IfThunk : Thunk
+{
+	const Thunk* left;
+	const Thunk* right;
+	const Thunk* thenBranch;
+	const Thunk* elseBranch;
+	IfThunk(const Thunk& thunk, const Thunk* left, const Thunk* right, const Thunk* thenBranch, const Thunk* elseBranch)
+		: Thunk(thunk), left(left), right(right), thenBranch(thenBranch), elseBranch(elseBranch) {}
+};
+
+// <function> хранит номер функции в таблице программы
+struct FunctionThunk : Thunk
+{
+	size_t function;
+	FunctionThunk(const Thunk& thunk, size_t function) : Thunk(thunk), function(function) {}
+};
+
+struct BlockThunk : Thunk
+{
+	const Thunk** items;
+	size_t count;
+	BlockThunk(const Thunk& thunk, const Thunk** items, size_t count) : Thunk(thunk), items(items), count(count) {}
+};
+
+// Скомпилированная программа
+// Узлы размещаются в собственной арене, AST должно жить не меньше программы:
+// замыкания и сообщения об ошибках ссылаются на его узлы
+class ThunkProgram
+{
+	Arena arena;
+	const Thunk* root = nullptr;
+	std::vector<const Thunk*> functions;  // Тела функций программы
+
+	friend class ThunkCompiler;
+public:
+	ThunkProgram() : arena(4 * 1024) {}
+
+	const Thunk* GetRoot() const;
+	const Thunk* GetFunctionBody(size_t function) const;
+
+	// Объём памяти, занимаемый узлами
+	size_t GetBytes() const;
+};
+
+// Компилятор AST в дерево узлов
+// AST должно быть обработано Resolver
+class ThunkCompiler
+{
+	ThunkProgram* program = nullptr;
+public:
+	std::unique_ptr<ThunkProgram> Compile(Expression*);
+
+protected:
+	// Методы компиляции конкретных выражений
+	const Thunk* CompileExpression(Expression*);
+	const Thunk* CompileExpression(ValExpression*);
+	const Thunk* CompileExpression(VarExpression*);
+	const Thunk* CompileExpression(AddExpression*);
+	const Thunk* CompileExpression(IfExpression*);
+	const Thunk* CompileExpression(LetExpression*);
+	const Thunk* CompileExpression(FunctionExpression*);
+	const Thunk* CompileExpression(CallExpression*);
+	const Thunk* CompileExpression(SetExpression*);
+	const Thunk* CompileExpression(BlockExpression*);
+
+	// Создать узел в арене программы
+	template<class T, class... Args> const Thunk* Create(Args&&... args);
+};
+
+template<class T, class... Args> inline const Thunk* ThunkCompiler::Create(Args&&... args)
+{
+	return program->arena.Create<T>(std::forward<Args>(args)...);
+}
@@ -0,0 +1,232 @@
+#include "ThunkExecutor.h"
+#include "Exceptions.h"
+
+ThunkExecutor::ThunkExecutor(const HeapOptions& options) : heap(options)
+{
+	global = heap.CreateScope(nullptr, 0);
+}
+
+const HeapStats& ThunkExecutor::GetHeapStats() const
+{
+	return heap.GetStats();
+}
+
+const ExecutionStats& ThunkExecutor::GetStats() const
+{
+	return stats;
+}
+
+// Выполнить программу
+// Выполнение начинается во внешней области видимости, в том числе
+// после ошибки предыдущей программы, прервавшей вложенные вызовы
+Value ThunkExecutor::Run(const ThunkProgram& program)
+{
+	this->program = &program;
+	scope = global;
+	depth = 0;
+	auto result = Eval(program.GetRoot());
+	scope = global;
+	return result;
+}
+
+// Выполнить узел
+// Узлы, которые не завершаются выражением в хвостовой позиции, не меняют
+// текущую область видимости и выполняются одним вызовом. Для остальных
+// области видимости, созданные на итерациях цикла, принадлежат этому
+// вызову Eval и освобождаются при выходе из него
+Value ThunkExecutor::Eval(const Thunk* thunk)
+{
+	Value result;
+	stats.steps++;
+	if (!thunk->tail)
+	{
+		thunk->run(thunk, *this, result);
+		return result;
+	}
+
+	if (++depth > stats.maxDepth) stats.maxDepth = depth;
+	auto saved = scope;
+	while ((thunk = thunk->run(thunk, *this, result)) != nullptr)
+	{
+		stats.steps++;
+	}
+	scope = std::move(saved);
+	depth--;
+	return result;
+}
+
+const Value& ThunkExecutor::ReadVariable(const VarThunk* var)
+{
+	return scope->Lookup(var->address);
+}
+
+template<> inline int ThunkExecutor::GetInteger<OperandKind::Val>(const Thunk* thunk)
+{
+	return static_cast<const ValThunk*>(thunk)->value;
+}
+
+template<> inline int ThunkExecutor::GetInteger<OperandKind::Var>(const Thunk* thunk)
+{
+	return IntegerVar(thunk, *this);
+}
+
+template<> inline int ThunkExecutor::GetInteger<OperandKind::Other>(const Thunk* thunk)
+{
+	return thunk->integer(thunk, *this);
+}
+
+const Thunk* ThunkExecutor::RunVal(const Thunk* thunk, ThunkExecutor&, Value& result)
+{
+	result = Value(static_cast<const ValThunk*>(thunk)->value);
+	return nullptr;
+}
+
+const Thunk* ThunkExecutor::RunVar(const Thunk* thunk, ThunkExecutor& executor, Value& result)
+{
+	result = executor.ReadVariable(static_cast<const VarThunk*>(thunk));
+	return nullptr;
+}
+
+const Thunk* ThunkExecutor::RunSet(const Thunk* thunk, ThunkExecutor& executor, Value& result)
+{
+	auto set = static_cast<const SetThunk*>(thunk);
+	auto value = executor.Eval(set->expression);
+	executor.scope->Lookup(set->address) = std::move(value);
+	result = Value();
+	return nullptr;
+}
+
+// Значение переменной вычисляется уже в новой области видимости,
+// чтобы определяемая в нём функция могла ссылаться на саму себя.
+// Тело находится в хвостовой позиции
+const Thunk* ThunkExecutor::RunLet(const Thunk* thunk, ThunkExecutor& executor, Value&)
+{
+	auto let = static_cast<const BinaryThunk*>(thunk);
+	executor.scope = executor.heap.CreateScope(std::move(executor.scope), 1);
+	auto value = executor.Eval(let->left);
+	executor.scope->GetSlot(0) = std::move(value);
+	return let->right;
+}
+
+const Thunk* ThunkExecutor::RunFunction(const Thunk* thunk, ThunkExecutor& executor, Value& result)
+{
+	auto function = static_cast<const FunctionThunk*>(thunk);
+	auto expression = static_cast<FunctionExpression*>(function->source);
+	result = Value(std::make_shared<Closure>(expression, executor.scope, function->function));
+	return nullptr;
+}
+
+const Thunk* ThunkExecutor::RunCall(const Thunk* thunk, ThunkExecutor& executor, Value&)
+{
+	auto call = static_cast<const BinaryThunk*>(thunk);
+	auto callable = executor.Eval(call->left);
+	return executor.EnterCall(call, callable);
+}
+
+const Thunk* ThunkExecutor::RunCallVar(const Thunk* thunk, ThunkExecutor& executor, Value&)
+{
+	auto call = static_cast<const BinaryThunk*>(thunk);
+	return executor.EnterCall(call, executor.ReadVariable(static_cast<const VarThunk*>(call->left)));
+}
+
+// Вызов функции, тело которой находится в хвостовой позиции
+// Область видимости вызывающего кода заменяется областью видимости вызова,
+// поэтому хвостовой вызов не накапливает области видимости
+const Thunk* ThunkExecutor::EnterCall(const BinaryThunk* call, const Value& callable)
+{
+	if (callable.GetType() != ValueType::Closure)
+		throw ExpressionIsNotCallableException(call->left->source);
+
+	// Из замыкания нужны только номер функции и область видимости её определения
+	// Берём их до вычисления аргумента, который может изменить переменную
+	auto& closure = callable.GetClosure();
+	auto body = program->GetFunctionBody(closure->GetEntry());
+	auto environment = closure->GetScope();
+
+	auto argument = Eval(call->right);
+	stats.calls++;
+
+	scope = heap.CreateScope(std::move(environment), 1);
+	scope->GetSlot(0) = std::move(argument);
+	return body;
+}
+
+// Выражения блока, кроме последнего, выполняются по порядку,
+// последнее находится в хвостовой позиции
+const Thunk* ThunkExecutor::RunBlock(const Thunk* thunk, ThunkExecutor& executor, Value&)
+{
+	auto block = static_cast<const BlockThunk*>(thunk);
+	auto last = block->items + block->count - 1;
+	for (auto item = block->items; item != last; item++)
+	{
+		executor.Eval(*item);
+	}
+	return *last;
+}
+
+template<OperandKind left, OperandKind right>
+const Thunk* ThunkExecutor::RunAdd(const Thunk* thunk, ThunkExecutor& executor, Value& result)
+{
+	result = Value(IntegerAdd<left, right>(thunk, executor));
+	return nullptr;
+}
+
+// Выбранная ветвь находится в хвостовой позиции
+template<OperandKind left, OperandKind right>
+const Thunk* ThunkExecutor::RunIf(const Thunk* thunk, ThunkExecutor& executor, Value&)
+{
+	auto branch = static_cast<const IfThunk*>(thunk);
+	int leftValue = executor.GetInteger<left>(branch->left);
+	int rightValue = executor.GetInteger<right>(branch->right);
+	return leftValue > rightValue ? branch->thenBranch : branch->elseBranch;
+}
+
+int ThunkExecutor::IntegerVal(const Thunk* thunk, ThunkExecutor&)
+{
+	return static_cast<const ValThunk*>(thunk)->value;
+}
+
+int ThunkExecutor::IntegerVar(const Thunk* thunk, ThunkExecutor& executor)
+{
+	auto& value = executor.ReadVariable(static_cast<const VarThunk*>(thunk));
+	if (value.GetType() != ValueType::Integer)
+		throw ExpressionIsNotValueException(thunk->source);
+	return value.GetInteger();
+}
+
+int ThunkExecutor::IntegerOther(const Thunk* thunk, ThunkExecutor& executor)
+{
+	auto value = executor.Eval(thunk);
+	if (value.GetType() != ValueType::Integer)
+		throw ExpressionIsNotValueException(thunk->source);
+	return value.GetInteger();
+}
+
+// Значение <add> всегда целое, поэтому как операнд оно
+// вычисляется без создания промежуточного Value
+template<OperandKind left, OperandKind right>
+int ThunkExecutor::IntegerAdd(const Thunk* thunk, ThunkExecutor& executor)
+{
+	auto add = static_cast<const BinaryThunk*>(thunk);
+	int leftValue = executor.GetInteger<left>(add->left);
+	int rightValue = executor.GetInteger<right>(add->right);
+	return AddIntegers(leftValue, rightValue);
+}
+
+const ThunkFunction ThunkExecutor::addFunctions[3][3] = {
+	{ RunAdd<OperandKind::Val, OperandKind::Val>, RunAdd<OperandKind::Val, OperandKind::Var>, RunAdd<OperandKind::Val, OperandKind::Other> },
+	{ RunAdd<OperandKind::Var, OperandKind::Val>, RunAdd<OperandKind::Var, OperandKind::Var>, RunAdd<OperandKind::Var, OperandKind::Other> },
+	{ RunAdd<OperandKind::Other, OperandKind::Val>, RunAdd<OperandKind::Other, OperandKind::Var>, RunAdd<OperandKind::Other, OperandKind::Other> }
+};
+
+const IntegerThunkFunction ThunkExecutor::integerAddFunctions[3][3] = {
+	{ IntegerAdd<OperandKind::Val, OperandKind::Val>, IntegerAdd<OperandKind::Val, OperandKind::Var>, IntegerAdd<OperandKind::Val, OperandKind::Other> },
+	{ IntegerAdd<OperandKind::Var, OperandKind::Val>, IntegerAdd<OperandKind::Var, OperandKind::Var>, IntegerAdd<OperandKind::Var, OperandKind::Other> },
+	{ IntegerAdd<OperandKind::Other, OperandKind::Val>, IntegerAdd<OperandKind::Other, OperandKind::Var>, IntegerAdd<OperandKind::Other, OperandKind::Other> }
+};
+
+const ThunkFunction ThunkExecutor::ifFunctions[3][3] = {
+	{ RunIf<OperandKind::Val, OperandKind::Val>, RunIf<OperandKind::Val, OperandKind::Var>, RunIf<OperandKind::Val, OperandKind::Other> },
+	{ RunIf<OperandKind::Var, OperandKind::Val>, RunIf<OperandKind::Var, OperandKind::Var>, RunIf<OperandKind::Var, OperandKind::Other> },
+	{ RunIf<OperandKind::Other, OperandKind::Val>, RunIf<OperandKind::Other, OperandKind::Var>, RunIf<OperandKind::Other, OperandKind::Other> }
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+# include "ThunkCompiler.h"
+# include "Value.h"
+# include "Scope.h"
+# include "Heap.h"
+# include "ExecutionStats.h"
+# include <memory>
+
+// Исполнитель программ ThunkCompiler
+// Третий механизм выполнения, наряду с Evaluator и VirtualMachine:
+// каждый узел выполняется прямым вызовом заранее выбранной функции,
+// без проверки типа узла. Как и в Evaluator, выражения в хвостовой
+// позиции выполняются в цикле Eval, поэтому хвостовая рекурсия
+// не расходует стэк C++
+
+// Вид операнда <add> и <if>, от которого зависит способ получить его значение
+enum class OperandKind {
+	Val,    // Литерал, значение хранится в узле
+	Var,    // Переменная, значение читается из ячейки без копирования
+	Other   // Любое другое выражение
+};
+
+class ThunkExecutor
+{
+	Heap heap;                        // Куча, в которой создаются области видимости
+	std::shared_ptr<Scope> global;    // Внешняя область видимости программы
+	std::shared_ptr<Scope> scope;     // Текущая область видимости
+	const ThunkProgram* program = nullptr; // Выполняемая программа
+	ExecutionStats stats;             // Счётчики выполнения
+	size_t depth = 0;                 // Глубина вложенных вызовов Eval
+
+	friend class ThunkCompiler;
+public:
+	ThunkExecutor(const HeapOptions& options = HeapOptions());
+
+	// Выполнить программу и вернуть её результат
+	Value Run(const ThunkProgram&);
+
+	const HeapStats& GetHeapStats() const; // Счётчики кучи
+	const ExecutionStats& GetStats() const; // Счётчики выполнения
+
+protected:
+	// Выполнить узел и все выражения в хвостовой позиции после него
+	Value Eval(const Thunk*);
+
+	// Ячейка переменной в текущей области видимости
+	const Value& ReadVariable(const VarThunk*);
+
+	// Получить целое значение операнда вида kind
+	template<OperandKind kind> int GetInteger(const Thunk*);
+
+	// Функции выполнения конкретных узлов, их выбирает ThunkCompiler
+	static const Thunk* RunVal(const Thunk*, ThunkExecutor&, Value&);
+	static const Thunk* RunVar(const Thunk*, ThunkExecutor&, Value&);
+	static const Thunk* RunSet(const Thunk*, ThunkExecutor&, Value&);
+	static const Thunk* RunLet(const Thunk*, ThunkExecutor&, Value&);
+	static const Thunk* RunFunction(const Thunk*, ThunkExecutor&, Value&);
+	static const Thunk* RunCall(const Thunk*, ThunkExecutor&, Value&);
+	static const Thunk* RunCallVar(const Thunk*, ThunkExecutor&, Value&);
+	static const Thunk* RunBlock(const Thunk*, ThunkExecutor&, Value&);
+	template<OperandKind left, OperandKind right> static const Thunk* RunAdd(const Thunk*, ThunkExecutor&, Value&);
+	template<OperandKind left, OperandKind right> static const Thunk* RunIf(const Thunk*, ThunkExecutor&, Value&);
+
+	// Функции получения целого значения узла
+	static int IntegerVal(const Thunk*, ThunkExecutor&);
+	static int IntegerVar(const Thunk*, ThunkExecutor&);
+	static int IntegerOther(const Thunk*, ThunkExecutor&);
+	template<OperandKind left, OperandKind right> static int IntegerAdd(const Thunk*, ThunkExecutor&);
+
+	// Функции <add> и <if> для всех сочетаний видов операндов, [левый][правый]
+	static const ThunkFunction addFunctions[3][3];
+	static const IntegerThunkFunction integerAddFunctions[3][3];
+	static const ThunkFunction ifFunctions[3][3];
+
+	// Вызвать замыкание callable с аргументом, вернуть тело функции
+	const Thunk* EnterCall(const BinaryThunk* call, const Value& callable);
+};
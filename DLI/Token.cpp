@@ -1,23 +1,23 @@
 #include "Token.h"
 
-std::string& KeywordToken::GetKeyword()
+Keyword KeywordToken::GetKeyword() const
 {
 	return keyword;
 }
 
 std::string KeywordToken::ToString() const
 {
-	return "Keyword(" + keyword + ")";
+	return "Keyword(" + std::string(GetKeywordName(keyword)) + ")";
 }
 
-std::string& IdentifierToken::GetId()
+Symbol IdentifierToken::GetId() const
 {
 	return id;
 }
 
 std::string IdentifierToken::ToString() const
 {
-	return "Identifier(" + id + ")";
+	return "Identifier(" + id.GetName() + ")";
 }
 
 int ValueToken::GetValue()
@@ -4,19 +4,30 @@
 # define TOKEN_H_INCLUDED
 
 # include <string>
+# include <type_traits>
 # include "Position.h"
+# include "Keywords.h"
+# include "SymbolTable.h"
 
 // Лексемы, читаемые лексическим анализатором
 
+// Тип лексемы
+// Синтаксический анализатор проверяет тип лексемы по нему, без dynamic_cast
+enum class TokenType
+{
+	Unknown, OpenBracket, CloseBracket, AssignOperator, Keyword, Identifier, Value
+};
 
 // Базовая лексема
 class Token {
 protected:
 	PositionInText position = { 0, 0 };
+	TokenType type = TokenType::Unknown;
 public:
-	Token(const PositionInText &position) : position(position) {}
+	Token(const PositionInText &position, TokenType type) : position(position), type(type) {}
 	Token() {}
 	const PositionInText& GetPosition() const;
+	TokenType GetType() const { return type; }
 	virtual ~Token() = default;
 	virtual std::string ToString() const;
 };
@@ -25,7 +36,8 @@ public:
 class OpenBracketToken : public Token 
 {
 public:
-	OpenBracketToken(const PositionInText& position) : Token(position) {}
+	static constexpr TokenType Type = TokenType::OpenBracket;
+	OpenBracketToken(const PositionInText& position) : Token(position, Type) {}
 	virtual std::string ToString() const;
 };
 
@@ -33,7 +45,8 @@ public:
 class CloseBracketToken : public Token 
 {
 public:
-	CloseBracketToken(const PositionInText& position) : Token(position) {}
+	static constexpr TokenType Type = TokenType::CloseBracket;
+	CloseBracketToken(const PositionInText& position) : Token(position, Type) {}
 	virtual std::string ToString() const;
 };
 
@@ -41,29 +54,33 @@ public:
 class AssignOperatorToken : public Token 
 {
 public:
-	AssignOperatorToken(const PositionInText& position) : Token(position) {}
+	static constexpr TokenType Type = TokenType::AssignOperator;
+	AssignOperatorToken(const PositionInText& position) : Token(position, Type) {}
 	virtual std::string ToString() const;
 };
 
 // Ключевое слово
 class KeywordToken : public Token 
 {
-	std::string keyword;
+	Keyword keyword;
 public:
-	KeywordToken(const KeywordToken& kw) : keyword(kw.keyword), Token(kw.position) {}
-	KeywordToken(std::string str, PositionInText& position) : keyword(str), Token(position) {}
-	std::string& GetKeyword();
+	static constexpr TokenType Type = TokenType::Keyword;
+	KeywordToken(const KeywordToken& kw) : keyword(kw.keyword), Token(kw.position, Type) {}
+	KeywordToken(Keyword keyword, const PositionInText& position) : keyword(keyword), Token(position, Type) {}
+	Keyword GetKeyword() const;
 	virtual std::string ToString() const;
 };
 
 // Идентификатор
+// Имя идентификатора хранится в таблице символов
 class IdentifierToken : public Token 
 {
-	std::string id;
+	Symbol id;
 public:
-	IdentifierToken(const IdentifierToken& id) : id(id.id), Token(id.position) {}
-	IdentifierToken(std::string id, const PositionInText& position) : id(id), Token(position) {}
-	std::string& GetId();
+	static constexpr TokenType Type = TokenType::Identifier;
+	IdentifierToken(const IdentifierToken& id) : id(id.id), Token(id.position, Type) {}
+	IdentifierToken(Symbol id, const PositionInText& position) : id(id), Token(position, Type) {}
+	Symbol GetId() const;
 	virtual std::string ToString() const;
 };
 
@@ -72,10 +89,16 @@ class ValueToken : public Token
 {
 	int value;
 public:
-	ValueToken(const ValueToken& val) : value(val.value), Token(val.position) {}
-	ValueToken(int value, const PositionInText& position) : value(value), Token(position) {}
+	static constexpr TokenType Type = TokenType::Value;
+	ValueToken(const ValueToken& val) : value(val.value), Token(val.position, Type) {}
+	ValueToken(int value, const PositionInText& position) : value(value), Token(position, Type) {}
 	int GetValue();
 	virtual std::string ToString() const;
 };
 
+// Память, в которой помещается лексема любого типа
+// Лексические анализаторы создают в ней лексемы размещающим new
+using TokenStorage = std::aligned_union_t<0, OpenBracketToken, CloseBracketToken,
+	AssignOperatorToken, KeywordToken, IdentifierToken, ValueToken>;
+
 #endif // !TOKEN_H_INCLUDED
@@ -0,0 +1,20 @@
+#pragma once
+
+# include "Token.h"
+
+// Поток лексем, из которого читает синтаксический анализатор
+// Лексемы выдаются по одной, с просмотром на одну лексему вперёд
+class TokenStream
+{
+public:
+	virtual ~TokenStream() = default;
+
+	// Прочитать следующую лексему
+	// Лексема действительна до следующего вызова Next,
+	// в конце потока возвращается nullptr
+	virtual Token* Next() = 0;
+
+	// Посмотреть следующую лексему, не читая её
+	// В конце потока возвращается nullptr
+	virtual Token* Peek() = 0;
+};
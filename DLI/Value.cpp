@@ -0,0 +1,29 @@
+#include "Value.h"
+
+FunctionExpression* Closure::GetFunction() const
+{
+	return function;
+}
+
+const std::shared_ptr<Scope>& Closure::GetScope() const
+{
+	return scope;
+}
+
+size_t Closure::GetEntry() const
+{
+	return entry;
+}
+
+std::string Value::ToString() const
+{
+	switch (type)
+	{
+		case ValueType::Integer:
+			return "(val " + std::to_string(integer) + ")";
+		case ValueType::Closure:
+			return closure->GetFunction()->ToString();
+		default:
+			return "(expr)";
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+# include "AST.h"
+# include <memory>
+# include <string>
+
+// Значения времени исполнения
+// Отделены от узлов AST: чтение переменной или литерала
+// не создаёт и не копирует узлы дерева
+
+class Scope;
+
+// Типы значений
+enum class ValueType {
+	Empty,    // Пустое значение, результат (set ...)
+	Integer,  // Целое число
+	Closure   // Замыкание
+};
+
+// Замыкание - функция вместе с областью видимости, в которой она определена
+class Closure
+{
+	FunctionExpression* function; // Определение функции в AST
+	std::shared_ptr<Scope> scope; // Замыкаемая область видимости, живёт не меньше замыкания
+	size_t entry;                 // Точка входа в код функции для виртуальной машины
+
+	// Рабочие поля сборщика циклов Heap
+	long gcReferences = 0;
+	bool gcListed = false;
+	friend class Heap;
+public:
+	Closure(FunctionExpression* function, std::shared_ptr<Scope> scope, size_t entry = 0) : function(function), scope(std::move(scope)), entry(entry) {}
+	FunctionExpression* GetFunction() const;
+	const std::shared_ptr<Scope>& GetScope() const;
+	size_t GetEntry() const;
+};
+
+// Значение: целое хранится непосредственно,
+// замыкание - через разделяемый указатель, копирование значения
+// не копирует ни замыкание, ни тело функции
+class Value
+{
+	ValueType type;
+	int integer = 0;
+	std::shared_ptr<Closure> closure;
+public:
+	Value() : type(ValueType::Empty) {}
+	Value(int integer) : type(ValueType::Integer), integer(integer) {}
+	Value(std::shared_ptr<Closure> closure) : type(ValueType::Closure), closure(std::move(closure)) {}
+
+	ValueType GetType() const { return type; }
+	int GetInteger() const { return integer; }
+	const std::shared_ptr<Closure>& GetClosure() const { return closure; }
+
+	// Представить значение в виде строки
+	std::string ToString() const;
+};
+
+// Сумма целых значений <add>
+// При переполнении результат берётся по модулю 2^32, поэтому он определён
+// и одинаков во всех способах выполнения и при свёртке констант оптимизатором
+inline int AddIntegers(int left, int right)
+{
+	return (int)((unsigned int)left + (unsigned int)right);
+}
@@ -0,0 +1,140 @@
+#include "VirtualMachine.h"
+#include "Exceptions.h"
+
+VirtualMachine::VirtualMachine(const HeapOptions& options) : heap(options)
+{
+	global = heap.CreateScope(nullptr, 0);
+}
+
+const HeapStats& VirtualMachine::GetHeapStats() const
+{
+	return heap.GetStats();
+}
+
+const ExecutionStats& VirtualMachine::GetStats() const
+{
+	return stats;
+}
+
+// Выполнить программу
+// Цикл выборки инструкций с диспетчеризацией через switch
+Value VirtualMachine::Run(const Program& program)
+{
+	auto& code = program.GetCode();
+	auto& functions = program.GetFunctions();
+	size_t pc = 0;          // Адрес текущей инструкции
+	auto scope = global;    // Текущая область видимости
+
+	stack.clear();
+	frames.clear();
+
+	while (true)
+	{
+		auto& instruction = code[pc++];
+		stats.steps++;
+		switch (instruction.code)
+		{
+			case OpCode::PushConst:
+				stack.emplace_back(instruction.a);
+				break;
+
+			case OpCode::PushEmpty:
+				stack.emplace_back();
+				break;
+
+			case OpCode::Load:
+				stack.push_back(scope->Lookup({ (unsigned int)instruction.a, instruction.b, true }));
+				break;
+
+			case OpCode::Store:
+				scope->Lookup({ (unsigned int)instruction.a, instruction.b, true }) = Pop();
+				break;
+
+			case OpCode::Pop:
+				stack.pop_back();
+				break;
+
+			case OpCode::ExpectInt:
+				if (stack.back().GetType() != ValueType::Integer)
+					throw ExpressionIsNotValueException(program.GetSource(pc - 1));
+				break;
+
+			case OpCode::ExpectClosure:
+				if (stack.back().GetType() != ValueType::Closure)
+					throw ExpressionIsNotCallableException(program.GetSource(pc - 1));
+				break;
+
+			case OpCode::Add:
+			{
+				int right = Pop().GetInteger();
+				int left = stack.back().GetInteger();
+				stack.back() = Value(AddIntegers(left, right));
+				break;
+			}
+
+			// Ветка then выполняется, если левое значение больше правого,
+			// иначе переходим на ветку else
+			case OpCode::BranchIfLe:
+			{
+				int right = Pop().GetInteger();
+				int left = Pop().GetInteger();
+				if (left <= right) pc = instruction.a;
+				break;
+			}
+
+			case OpCode::Jump:
+				pc = instruction.a;
+				break;
+
+			case OpCode::EnterScope:
+				scope = heap.CreateScope(std::move(scope), 1);
+				break;
+
+			case OpCode::LeaveScope:
+				// Область видимости освобождается, если её не захватило замыкание
+				scope = scope->GetParent();
+				break;
+
+			case OpCode::MakeClosure:
+			{
+				auto& function = functions[instruction.a];
+				// Замыкание разделяет владение областью видимости
+				stack.emplace_back(std::make_shared<Closure>(function.function, scope, function.entry));
+				break;
+			}
+
+			case OpCode::Call:
+			{
+				auto argument = Pop();
+				auto callable = Pop();
+				auto& closure = callable.GetClosure();
+				frames.push_back({ pc, std::move(scope) });
+				stats.calls++;
+				if (frames.size() > stats.maxDepth) stats.maxDepth = frames.size();
+				scope = heap.CreateScope(closure->GetScope(), 1);
+				scope->GetSlot(0) = argument;
+				pc = closure->GetEntry();
+				break;
+			}
+
+			case OpCode::Return:
+			{
+				auto& frame = frames.back();
+				scope = std::move(frame.scope);
+				pc = frame.returnAddress;
+				frames.pop_back();
+				break;
+			}
+
+			case OpCode::Halt:
+				return Pop();
+		}
+	}
+}
+
+Value VirtualMachine::Pop()
+{
+	auto value = std::move(stack.back());
+	stack.pop_back();
+	return value;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+# include "Bytecode.h"
+# include "Value.h"
+# include "Scope.h"
+# include "Heap.h"
+# include "ExecutionStats.h"
+# include <memory>
+# include <vector>
+
+// Стэковая виртуальная машина, исполняющая байт-код Compiler
+// Альтернатива Evaluator: вызовы функций не используют стэк C++,
+// а узлы AST не обходятся во время выполнения
+
+class VirtualMachine
+{
+	// Запись активации вызова функции
+	struct Frame
+	{
+		size_t returnAddress; // Адрес возврата
+		std::shared_ptr<Scope> scope; // Область видимости вызывающего кода
+	};
+
+	Heap heap;                           // Куча, в которой создаются области видимости
+	std::vector<Value> stack;            // Стэк значений
+	std::vector<Frame> frames;           // Стэк вызовов
+	std::shared_ptr<Scope> global;       // Внешняя область видимости программы
+	ExecutionStats stats;                // Счётчики выполнения
+public:
+	VirtualMachine(const HeapOptions& options = HeapOptions());
+
+	// Выполнить программу и вернуть её результат
+	Value Run(const Program&);
+
+	const HeapStats& GetHeapStats() const; // Счётчики кучи
+	const ExecutionStats& GetStats() const; // Счётчики выполнения
+
+protected:
+	Value Pop();               // Снять значение со стэка
+};